@@ -32,6 +32,15 @@
             CHECK_CUDA_ERROR( {}, name );                                      \
         }
 
+    // Calls a Kernel once per line of the grid instead of once per grid point, for
+    // example for independent solves along the rows or columns. The grid size is
+    // derived from the number of lines.
+    #define CALL_LINE_KERNEL( func, name, lines, block, ... )                      \
+        {                                                                          \
+            func<<<( ( lines ) + block.x - 1 ) / block.x, block>>>( 0, __VA_ARGS__ ); \
+            CHECK_CUDA_ERROR( {}, name );                                          \
+        }
+
 #else
     // On the CPU, the check for CUDA errors does nothing
     #define CHECK_CUDA_ERROR( func, msg )
@@ -56,6 +65,13 @@
                     func( i, __VA_ARGS__ );                                                                                                     \
             }                                                                                                                                   \
         }
+    // Calls a Kernel once per line of the grid. The lines are distributed over the threads.
+    #define CALL_LINE_KERNEL( func, name, lines, block, ... )                                                                     \
+        {                                                                                                                         \
+            _Pragma( "omp parallel for schedule(static) num_threads(system.omp_max_threads)" ) for ( int line = 0; line < ( lines ); ++line ) { \
+                func( line, __VA_ARGS__ );                                                                                        \
+            }                                                                                                                     \
+        }
 #endif
 
 // Swaps symbols a and b
@@ -25,6 +25,9 @@ class CUDAMatrix : CUDAMatrixBase {
     unsigned int rows, cols;
     // The total Size of the Matrix = rows*cols. Used for allocation purposes.
     unsigned int total_size;
+    // Number of padding elements in front of and behind the device data. The device pointer points behind
+    // the leading padding, so kernels can read a few elements outside of the matrix without bounds checks.
+    unsigned int halo;
     // Name of the Matrix. Mostly used for debugging purposes.
     std::string name;
 
@@ -49,23 +52,24 @@ class CUDAMatrix : CUDAMatrixBase {
         rows = 0;
         cols = 0;
         total_size = 0;
+        halo = 0;
         is_on_device = false;
         is_on_host = false;
         host_is_ahead = false;
     };
 
-    CUDAMatrix( CUDAMatrix& other ) : rows( other.rows ), cols( other.cols ), total_size( other.total_size ), name( other.name ), device_data( other.device_data ), host_data( other.host_data ) {
+    CUDAMatrix( CUDAMatrix& other ) : rows( other.rows ), cols( other.cols ), total_size( other.total_size ), halo( other.halo ), name( other.name ), device_data( other.device_data ), host_data( other.host_data ) {
         other.total_size = 0;
         other.cols = 0;
         other.rows = 0;
     }
-    CUDAMatrix( CUDAMatrix&& other ) : rows( other.rows ), cols( other.cols ), total_size( other.total_size ), name( other.name ), device_data( other.device_data ), host_data( other.host_data ) {
+    CUDAMatrix( CUDAMatrix&& other ) : rows( other.rows ), cols( other.cols ), total_size( other.total_size ), halo( other.halo ), name( other.name ), device_data( other.device_data ), host_data( other.host_data ) {
         other.total_size = 0;
         other.cols = 0;
         other.rows = 0;
     }
 
-    CUDAMatrix( unsigned int rows, unsigned int cols, const std::string& name ) : rows( rows ), cols( cols ), name( name ) {
+    CUDAMatrix( unsigned int rows, unsigned int cols, const std::string& name ) : rows( rows ), cols( cols ), halo( 0 ), name( name ) {
         construct( rows, cols, name );
     }
 
@@ -193,12 +197,14 @@ class CUDAMatrix : CUDAMatrixBase {
 
     /**
      * Constructs the Device Matrix vector. This function only allocates the memory and does not copy any data.
+     * @param halo: number of zero initialized padding elements in front of and behind the device data
      * @return: ptr to this matrix.
     */
-    CUDAMatrix<T>& constructDevice( unsigned int rows, unsigned int cols, const std::string& name ) {
+    CUDAMatrix<T>& constructDevice( unsigned int rows, unsigned int cols, const std::string& name, unsigned int halo = 0 ) {
         // Calculate the total size of this matrix as well as its size in bytes
         total_size = rows * cols;
-        size_in_mb = total_size * sizeof( T ) / 1024.0 / 1024.0;
+        this->halo = halo;
+        size_in_mb = ( total_size + 2 * halo ) * sizeof( T ) / 1024.0 / 1024.0;
         // Add the size to the global counter for the device sizes and update the maximum encountered memory size
         global_total_device_mb += size_in_mb;
         global_total_device_mb_max = std::max( global_total_device_mb, global_total_device_mb_max );
@@ -210,7 +216,7 @@ class CUDAMatrix : CUDAMatrixBase {
         if ( global_matrix_creation_log )
             std::cout << PC3::CLIO::prettyPrint( "Allocating " + std::to_string(size_in_mb) + " MB for " + std::to_string(rows) + "x" + std::to_string(cols) + " device matrix '" + name + "', total allocated device space: " + std::to_string(global_total_device_mb) + " MB." , PC3::CLIO::Control::Info | PC3::CLIO::Control::Secondary) << std::endl;
         // Reserve space on the device. When using nvcc, this allocates device memory on the GPU using thrust. When using gcc, this allocates memory for the CPU using std::vector.
-        device_data.resize( total_size );
+        device_data.resize( total_size + 2 * halo );
         // This matrix is now on device
         is_on_device = true;
         // And the Device Matrix is now ahead of the host matrix
@@ -304,13 +310,22 @@ class CUDAMatrix : CUDAMatrixBase {
             return *this;
         // If the matrix does not exist on device yet, create it from host parameters
         if ( not is_on_device and total_size > 0 )
-            constructDevice( rows, cols, name );
+            constructDevice( rows, cols, name, halo );
         // Log this action
         if ( global_matrix_transfer_log )
             std::cout << PC3::CLIO::prettyPrint( "Copying " + std::to_string(rows) + "x" + std::to_string(cols) + " matrix to device matrix '" + name + "'" , PC3::CLIO::Control::Info | PC3::CLIO::Control::Secondary) << std::endl;
         // Because we use std::vectors for host and device when using gcc, and thrust::host_vector and thrust::device_vector when using nvcc, we
         // can just call device_data = host_data and std:: or thrust:: will take care of the rest. Internally, this will memcopy in both cases.
-        device_data = host_data;
+        // With a halo, only the matrix itself is copied and the padding is kept.
+        if ( halo == 0 ) {
+            device_data = host_data;
+        } else {
+        #ifdef USE_CPU
+            std::copy( host_data.begin(), host_data.end(), device_data.begin() + halo );
+        #else
+            thrust::copy( host_data.begin(), host_data.end(), device_data.begin() + halo );
+        #endif
+        }
         // The Device Matrix is now ahead of the Host matrix
         host_is_ahead = false;
         // Return this pointer.
@@ -336,7 +351,15 @@ class CUDAMatrix : CUDAMatrixBase {
             std::cout << PC3::CLIO::prettyPrint( "Copying " + std::to_string(rows) + "x" + std::to_string(cols) + " matrix from device matrix '" + name + "'", PC3::CLIO::Control::Info | PC3::CLIO::Control::Secondary) << std::endl;
         // Because we use std::vectors for host and device when using gcc, and thrust::host_vector and thrust::device_vector when using nvcc, we
         // can just call host_data = device_data and std:: or thrust:: will take care of the rest. Internally, this will memcopy in both cases.
-        host_data = device_data;
+        if ( halo == 0 ) {
+            host_data = device_data;
+        } else {
+        #ifdef USE_CPU
+            std::copy( dbegin(), dend(), host_data.begin() );
+        #else
+            thrust::copy( dbegin(), dend(), host_data.begin() );
+        #endif
+        }
         // The Host Matrix is now ahead of the device matrix
         host_is_ahead = true;
         // Return this pointer
@@ -353,6 +376,7 @@ class CUDAMatrix : CUDAMatrixBase {
             return;
         std::swap( device_data, other.device_data );
         std::swap( host_data, other.host_data );
+        std::swap( halo, other.halo );
     }
 
     /**
@@ -394,9 +418,9 @@ class CUDAMatrix : CUDAMatrixBase {
         Type::host_vector<T> buffer_out( size );
         // In this case, we need to use std::copy for gcc and thrust::copy for nvcc.
         #ifdef USE_CPU
-            std::copy( device_data.begin() + start, device_data.begin() + start + size, buffer_out.begin() );
+            std::copy( dbegin() + start, dbegin() + start + size, buffer_out.begin() );
         #else
-            thrust::copy( device_data.begin() + start, device_data.begin() + start + size, buffer_out.begin() );
+            thrust::copy( dbegin() + start, dbegin() + start + size, buffer_out.begin() );
         #endif
         // And return the final buffer
         return buffer_out;
@@ -409,6 +433,13 @@ class CUDAMatrix : CUDAMatrixBase {
         return total_size;
     }
 
+    /**
+     * Returns the number of padding elements in front of and behind the device data.
+    */
+    inline unsigned int getHalo() const {
+        return halo;
+    }
+
     /**
      * Returns the raw pointer to the device memory. This is used in the Kernels, because they 
      * cannot directly work with std::vector or thrust::device_vectors.
@@ -419,10 +450,10 @@ class CUDAMatrix : CUDAMatrixBase {
             hostToDeviceSync();
         // Return .data() if using gcc, and a raw_pointer_cast if using gcc.
         #ifdef USE_CPU
-            return device_data.data();
+            return device_data.data() + halo;
         #else
             // Get the smart pointer from device_data.data() and convert it into a raw pointer
-            return thrust::raw_pointer_cast( device_data.data() );
+            return thrust::raw_pointer_cast( device_data.data() ) + halo;
         #endif
     }
 
@@ -453,10 +484,10 @@ class CUDAMatrix : CUDAMatrixBase {
      * These can be used functions like thrust::reduce or std::reduce
     */
     inline auto dbegin() {
-        return device_data.begin();
+        return device_data.begin() + halo;
     }
     inline auto dend() {
-        return device_data.end();
+        return device_data.end() - halo;
     }
     inline auto hbegin() {
         return host_data.begin();
@@ -488,7 +519,7 @@ class CUDAMatrix : CUDAMatrixBase {
         return getHostPtr()[row * rows + column];
     }
     inline T deviceAt(int index) const {
-        return device_data[index];
+        return device_data[index + halo];
     }
 };
 
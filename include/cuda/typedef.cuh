@@ -66,13 +66,6 @@ namespace PC3::Type {
         template <typename T>
         using device_vector = thrust::device_vector<T>;
     #endif
-
-    // Random Generator States
-    #ifdef USE_CPU
-        using cuda_random_state = std::mt19937;
-    #else
-        using cuda_random_state = curandState;
-    #endif
 }
 
 #ifdef USE_CPU
@@ -168,6 +161,10 @@ namespace PC3::CUDA {
         using thrust::sin;
         using thrust::cos;
         using thrust::abs;
+        // thrust::exp is only defined for complex numbers
+        PULSE_HOST_DEVICE static PULSE_INLINE Type::real exp( const Type::real x ) {
+            return ::exp( x );
+        }
     #endif
 
 } // namespace PC3::CUDA
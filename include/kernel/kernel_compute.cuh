@@ -1,6 +1,5 @@
 #pragma once
 #include "cuda/typedef.cuh"
-#include "kernel_coefficients_dormand_prince.cuh"
 #include "solver/matrix_container.hpp"
 #include "solver/gpu_solver.hpp"
 #include "system/system_parameters.hpp"
@@ -27,37 +26,107 @@ namespace PC3::Kernel {
             int start;
             Type::real weights[10];
             template <typename ...Args>
-            Weights( Args... _weights ) : n(sizeof...(_weights)), start(0) {
+            Weights( Args... _weights ) : n(sizeof...(_weights)), start(-1) {
                 double _w[] = { _weights... };
                 for (int i = 0; i < n; i++) {
-                    // If the weight is smaller than -1E10, we skip this weight, until we find a valid one
-                    if (_w[i] != 0.0 and start == 0 ) 
+                    // Leading zero weights are skipped, so start at the first nonzero weight
+                    if (_w[i] != 0.0 and start < 0 ) 
                         start = i;
-                    // Always assign the weight, even if it is invalid
+                    // Always assign the weight, even if it is zero
                     weights[i] = Type::real(_w[i]);
                 }
+                if ( start < 0 )
+                    start = 0;
             }
         };
+
+        // Adds the weighted Ks with indices below n_max to wf and rv
+        PULSE_DEVICE PULSE_INLINE void sum_ks( int i, MatrixContainer::Pointers& dev_ptrs, const Weights& weights, const int n_max, const bool minus, Type::complex& wf, Type::complex& rv ) {
+            const int n_end = weights.n < n_max ? weights.n : n_max;
+            for (int n = weights.start; n < n_end; n++) {
+                const auto w = weights.weights[n];
+                if ( w == 0.0 )
+                    continue;
+                switch (n) { 
+                    case 0: wf += w * ( minus ? dev_ptrs.k1_wavefunction_minus : dev_ptrs.k1_wavefunction_plus )[i]; rv += w * ( minus ? dev_ptrs.k1_reservoir_minus : dev_ptrs.k1_reservoir_plus )[i]; break;
+                    case 1: wf += w * ( minus ? dev_ptrs.k2_wavefunction_minus : dev_ptrs.k2_wavefunction_plus )[i]; rv += w * ( minus ? dev_ptrs.k2_reservoir_minus : dev_ptrs.k2_reservoir_plus )[i]; break;
+                    case 2: wf += w * ( minus ? dev_ptrs.k3_wavefunction_minus : dev_ptrs.k3_wavefunction_plus )[i]; rv += w * ( minus ? dev_ptrs.k3_reservoir_minus : dev_ptrs.k3_reservoir_plus )[i]; break;
+                    case 3: wf += w * ( minus ? dev_ptrs.k4_wavefunction_minus : dev_ptrs.k4_wavefunction_plus )[i]; rv += w * ( minus ? dev_ptrs.k4_reservoir_minus : dev_ptrs.k4_reservoir_plus )[i]; break;
+                    case 4: wf += w * ( minus ? dev_ptrs.k5_wavefunction_minus : dev_ptrs.k5_wavefunction_plus )[i]; rv += w * ( minus ? dev_ptrs.k5_reservoir_minus : dev_ptrs.k5_reservoir_plus )[i]; break;
+                    case 5: wf += w * ( minus ? dev_ptrs.k6_wavefunction_minus : dev_ptrs.k6_wavefunction_plus )[i]; rv += w * ( minus ? dev_ptrs.k6_reservoir_minus : dev_ptrs.k6_reservoir_plus )[i]; break;
+                    case 6: wf += w * ( minus ? dev_ptrs.k7_wavefunction_minus : dev_ptrs.k7_wavefunction_plus )[i]; rv += w * ( minus ? dev_ptrs.k7_reservoir_minus : dev_ptrs.k7_reservoir_plus )[i]; break;
+                    case 7: wf += w * ( minus ? dev_ptrs.k8_wavefunction_minus : dev_ptrs.k8_wavefunction_plus )[i]; rv += w * ( minus ? dev_ptrs.k8_reservoir_minus : dev_ptrs.k8_reservoir_plus )[i]; break;
+                    case 8: wf += w * ( minus ? dev_ptrs.k9_wavefunction_minus : dev_ptrs.k9_wavefunction_plus )[i]; rv += w * ( minus ? dev_ptrs.k9_reservoir_minus : dev_ptrs.k9_reservoir_plus )[i]; break;
+                    case 9: wf += w * ( minus ? dev_ptrs.k10_wavefunction_minus : dev_ptrs.k10_wavefunction_plus )[i]; rv += w * ( minus ? dev_ptrs.k10_reservoir_minus : dev_ptrs.k10_reservoir_plus )[i]; break;
+                }
+            }
+        }
+
+        /**
+         * Coefficients of a single 2N-storage (Williamson) stage. The only register dU is the K1 matrix.
+         * dU = a * dU + dt * K, out = in + b * dU
+         */
+        struct LowStorageStage {
+            Type::real a;
+            Type::real b;
+        };
+
+        // Updates the register and writes the next state of a single component for a low storage stage
+        PULSE_DEVICE PULSE_INLINE void low_storage_sum( int i, Type::complex dt, MatrixContainer::Pointers& dev_ptrs, InputOutput& io, const LowStorageStage& stage, const Type::complex k_wf, const Type::complex k_rv, const bool minus ) {
+            Type::complex* du_wf = minus ? dev_ptrs.k1_wavefunction_minus : dev_ptrs.k1_wavefunction_plus;
+            Type::complex* du_rv = minus ? dev_ptrs.k1_reservoir_minus : dev_ptrs.k1_reservoir_plus;
+            Type::complex wf = dt * k_wf;
+            Type::complex rv = dt * k_rv;
+            // The register is not initialized before the first stage, which always has a = 0
+            if ( stage.a != 0.0 ) {
+                wf += stage.a * du_wf[i];
+                rv += stage.a * du_rv[i];
+            }
+            du_wf[i] = wf;
+            du_rv[i] = rv;
+            ( minus ? io.out_wf_minus : io.out_wf_plus )[i] = ( minus ? io.in_wf_minus : io.in_wf_plus )[i] + stage.b * wf;
+            ( minus ? io.out_rv_minus : io.out_rv_plus )[i] = ( minus ? io.in_rv_minus : io.in_rv_plus )[i] + stage.b * rv;
+        }
+
         PULSE_GLOBAL void runge_sum_to_input_ki( int i, Type::complex dt, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, InputOutput io );
         PULSE_GLOBAL void runge_sum_to_input_kw( int i, Type::complex dt, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, InputOutput io, RK::Weights weights );
-        PULSE_GLOBAL void runge_sum_to_error( int i, Type::complex dt, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, RK::Weights weights );
     } // namespace RK
 
     namespace Compute {
 
         PULSE_GLOBAL void gp_tetm( int i, Type::real t, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io );
         PULSE_GLOBAL void gp_scalar( int i, Type::real t, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io );
+        // 2N-storage RK stages updating the single register K1 and the state in the same pass
+        PULSE_GLOBAL void gp_tetm_low_storage( int i, Type::real t, Type::complex dt, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io, RK::LowStorageStage stage );
+        PULSE_GLOBAL void gp_scalar_low_storage( int i, Type::real t, Type::complex dt, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io, RK::LowStorageStage stage );
 
+        PULSE_GLOBAL void gp_scalar_linear_propagator( int i, Type::real t, Type::complex dtc, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io );
         PULSE_GLOBAL void gp_scalar_linear_fourier( int i, Type::real t, Type::complex dtc, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io );
         PULSE_GLOBAL void gp_scalar_nonlinear( int i, Type::real t, Type::complex dtc, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io );
+        PULSE_GLOBAL void gp_scalar_nonlinear_midpoint( int i, Type::real t, Type::complex dtc, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io );
         PULSE_GLOBAL void gp_scalar_independent( int i, Type::real t, Type::complex dtc, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io );
+        PULSE_GLOBAL void gp_tetm_linear_propagator( int i, Type::real t, Type::complex dtc, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io );
         PULSE_GLOBAL void gp_tetm_linear_fourier( int i, Type::real t, Type::complex dtc, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io );
         PULSE_GLOBAL void gp_tetm_nonlinear( int i, Type::real t, Type::complex dtc, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io );
+        PULSE_GLOBAL void gp_tetm_nonlinear_midpoint( int i, Type::real t, Type::complex dtc, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io );
         PULSE_GLOBAL void gp_tetm_independent( int i, Type::real t, Type::complex dtc, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io );
 
     } // namespace Compute
 
-    PULSE_GLOBAL void initialize_random_number_generator(int i, unsigned int seed, Type::cuda_random_state* state, const unsigned int N);
-    PULSE_GLOBAL void generate_random_numbers(int i, Type::cuda_random_state* state, Type::complex* buffer, const unsigned int N, const Type::real real_amp, const Type::real imag_amp);
+    // Alternating direction implicit (Peaceman-Rachford) sweeps for the Laplacian
+    namespace ADI {
+        // Layout of the precomputed line coefficients of length n: Thomas factors c'[n], 1/m[n],
+        // the Sherman-Morrison correction z[n], its prefactor q and the inverse denominator.
+        PULSE_HOST_DEVICE PULSE_INLINE int coefficient_size( const int n ) {
+            return 3 * n + 2;
+        }
+        PULSE_GLOBAL void adi_sweep( int i, Type::complex* PULSE_RESTRICT in, Type::complex* PULSE_RESTRICT out, Type::complex* coefficients, Type::complex r_implicit, Type::complex r_explicit, const int n, const int stride_implicit, const int m, const int stride_explicit, const bool periodic_implicit, const bool periodic_explicit );
+    } // namespace ADI
+
+    // Copies the last and the first row of the N_x x N_y matrix buffer into the halo in front of and behind it, see MatrixContainer
+    PULSE_GLOBAL void fill_halo( int i, Type::complex* buffer, const int N_x, const int N_y );
+
+    // Fills buffer with complex normal random numbers of the given step, see kernel/kernel_random_numbers.cuh
+    PULSE_GLOBAL void generate_random_numbers(int i, Type::complex* buffer, const unsigned int N, const unsigned int seed, const unsigned int step, const Type::real real_amp, const Type::real imag_amp);
 
 } // namespace PC3::Kernel
\ No newline at end of file
@@ -6,8 +6,28 @@ namespace PC3::Kernel {
 
 PULSE_GLOBAL void kernel_make_fft_visible( int i, Type::complex* input, Type::complex* output, const unsigned int N );
 
-PULSE_GLOBAL void fft_shift_2D( int i, Type::complex* data, const unsigned int N_x, const unsigned int N_y );
-
 PULSE_GLOBAL void kernel_mask_fft( int i, Type::complex* data, Type::real* mask, const unsigned int N );
 
+/**
+ * Returns the index of the element that an fftshift moves to position i, i.e. shifted[i] = data[fft_shift_index(i)].
+ * The fftshift moves k = 0 to the center (N/2 rounded down). This is used to shift the FFT for visualization
+ * and output without an additional pass over the data.
+ */
+PULSE_HOST_DEVICE PULSE_INLINE int fft_shift_index( int i, const unsigned int N_x, const unsigned int N_y ) {
+    const int k = i / N_x;
+    const int l = i % N_x;
+    return ( ( k + N_y - N_y / 2 ) % N_y ) * N_x + ( l + N_x - N_x / 2 ) % N_x;
+}
+
+/**
+ * Returns the index of the element that an ifftshift moves to position i, i.e. unshifted[i] = data[ifft_shift_index(i)].
+ * The ifftshift inverts the fftshift, so for odd N_x or N_y the two differ by one sample. This is used to
+ * pre-shift the centered FFT mask.
+ */
+PULSE_HOST_DEVICE PULSE_INLINE int ifft_shift_index( int i, const unsigned int N_x, const unsigned int N_y ) {
+    const int k = i / N_x;
+    const int l = i % N_x;
+    return ( ( k + N_y / 2 ) % N_y ) * N_x + ( l + N_x / 2 ) % N_x;
+}
+
 }
\ No newline at end of file
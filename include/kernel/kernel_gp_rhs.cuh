@@ -0,0 +1,218 @@
+#pragma once
+#include "cuda/typedef.cuh"
+#include "kernel/kernel_compute.cuh"
+#include "kernel/kernel_hamilton.cuh"
+
+/*
+ * Right hand sides of the GP equations. These are shared by all kernels that evaluate
+ * the full right hand side, for example the K kernels and the fused RK stage kernels.
+ */
+namespace PC3::Kernel::Compute {
+
+    /**
+     * Mode without TE/TM Splitting
+     * The differential equation for this model reduces to
+     * ...
+     * gp_scalar_rhs evaluates the right hand side K at index i from the wavefunction in_wf and the
+     * reservoir value in_rv. If with_reservoir is false, the reservoir K is not evaluated and set to zero.
+     */
+    PULSE_DEVICE PULSE_INLINE void gp_scalar_rhs( int i, MatrixContainer::Pointers& dev_ptrs, SystemParameters::KernelParameters& p, Solver::TemporalEvelope::Pointers& oscillation_pulse, Solver::TemporalEvelope::Pointers& oscillation_pump, Solver::TemporalEvelope::Pointers& oscillation_potential, Type::complex* in_wf_plus, const Type::complex in_rv, Type::complex& k_wf, Type::complex& k_rv, const bool with_reservoir = true ) {
+        const Type::complex in_wf = in_wf_plus[i];
+
+        // The integrating factor iterator propagates the kinetic term in k-space and sets m_eff_scaled to zero
+        Type::complex hamilton = 0.0;
+        if ( p.m_eff_scaled != 0.0 ) {
+            hamilton = p.m2_over_dx2_p_dy2 * in_wf;
+            if ( p.halo_padding )
+                hamilton += Hamilton::scalar_neighbours_padded( in_wf_plus, i, i % p.N_x /*Col*/, p.N_x, p.one_over_dx2, p.one_over_dy2, p.periodic_boundary_x );
+            else
+                hamilton += Hamilton::scalar_neighbours( in_wf_plus, i, i / p.N_x /*Row*/, i % p.N_x /*Col*/, p.N_x, p.N_y, p.one_over_dx2, p.one_over_dy2, p.periodic_boundary_x, p.periodic_boundary_y );
+        }
+
+        const Type::real in_psi_norm = CUDA::abs2( in_wf );
+    
+        // MARK: Wavefunction
+        Type::complex result = p.minus_i_over_h_bar_s * ( p.m_eff_scaled * hamilton );
+
+        for (int k = 0; k < oscillation_potential.n; k++) {
+            const size_t offset = k * p.N_x * p.N_y;
+            const Type::complex potential = dev_ptrs.potential_plus[i+offset] * oscillation_potential.amp[k];
+            result += p.minus_i_over_h_bar_s * potential * in_wf;
+        }
+
+        result += p.minus_i_over_h_bar_s * p.g_c * in_psi_norm * in_wf;
+        result += p.minus_i_over_h_bar_s * p.g_r * in_rv * in_wf;
+        result += Type::real(0.5) * p.R * in_rv * in_wf;
+        result -= Type::real(0.5) * p.gamma_c * in_wf;
+
+        // MARK: Pulse
+        for (int k = 0; k < oscillation_pulse.n; k++) {
+            const size_t offset = k * p.N_x * p.N_y;
+            const Type::complex pulse = dev_ptrs.pulse_plus[i+offset];
+            result += p.one_over_h_bar_s * pulse * oscillation_pulse.amp[k];
+        }
+    
+        // MARK: Stochastic
+        if (p.stochastic_amplitude > 0.0) {
+            const Type::complex dw_over_dt = dev_ptrs.random_number[i] * CUDA::sqrt( ( p.R * in_rv + p.gamma_c ) / (Type::real(4.0) * p.dV * p.dt) );
+            result -= p.minus_i_over_h_bar_s * p.g_c * in_wf / p.dV - dw_over_dt;
+        }
+    
+        k_wf = result;
+        k_rv = 0.0;
+        if ( not with_reservoir )
+            return;
+    
+        // MARK: Reservoir
+        result = -p.gamma_r * in_rv;
+        result -= p.R * in_psi_norm * in_rv;
+        for (int k = 0; k < oscillation_pump.n; k++) {
+            const int offset = k * p.N_x * p.N_y;
+                result += dev_ptrs.pump_plus[i+offset] * oscillation_pump.amp[k];
+        }
+
+        // MARK: Stochastic-2
+        if (p.stochastic_amplitude > 0.0)
+            result += p.R * in_rv / p.dV;
+        k_rv = result;
+    }
+
+    // Evaluates the right hand side K of the scalar model at index i from the state io.in
+    PULSE_DEVICE PULSE_INLINE void gp_scalar_rhs( int i, MatrixContainer::Pointers& dev_ptrs, SystemParameters::KernelParameters& p, Solver::TemporalEvelope::Pointers& oscillation_pulse, Solver::TemporalEvelope::Pointers& oscillation_pump, Solver::TemporalEvelope::Pointers& oscillation_potential, InputOutput& io, Type::complex& k_wf, Type::complex& k_rv ) {
+        gp_scalar_rhs( i, dev_ptrs, p, oscillation_pulse, oscillation_pump, oscillation_potential, io.in_wf_plus, io.in_rv_plus[i], k_wf, k_rv );
+    }
+
+    /**
+     * Evaluates the right hand side K of the TE/TM model at index i from the wavefunctions wf_plus, wf_minus
+     * and the reservoir values in_rv_plus, in_rv_minus. If with_reservoir is false, the reservoir Ks are not
+     * evaluated and set to zero.
+     */
+    PULSE_DEVICE PULSE_INLINE void gp_tetm_rhs( int i, MatrixContainer::Pointers& dev_ptrs, SystemParameters::KernelParameters& p, Solver::TemporalEvelope::Pointers& oscillation_pulse, Solver::TemporalEvelope::Pointers& oscillation_pump, Solver::TemporalEvelope::Pointers& oscillation_potential, Type::complex* wf_plus, Type::complex* wf_minus, const Type::complex in_rv_plus, const Type::complex in_rv_minus, Type::complex& k_wf_plus, Type::complex& k_wf_minus, Type::complex& k_rv_plus, Type::complex& k_rv_minus, const bool with_reservoir = true ) {
+        const int row = i / p.N_x;
+        const int col = i % p.N_x;
+
+        const auto in_wf_plus = wf_plus[i];
+        const auto in_wf_minus = wf_minus[i];
+
+        // The integrating factor iterator propagates the kinetic and TE/TM terms in k-space and sets m_eff_scaled and delta_LT to zero
+        Type::complex hamilton_regular_plus = 0.0, hamilton_regular_minus = 0.0;
+        Type::complex hamilton_cross_plus = 0.0, hamilton_cross_minus = 0.0;
+        if ( p.m_eff_scaled != 0.0 or p.delta_LT != 0.0 ) {
+            hamilton_regular_plus = p.m2_over_dx2_p_dy2 * in_wf_plus;
+            hamilton_regular_minus = p.m2_over_dx2_p_dy2 * in_wf_minus;
+            if ( p.halo_padding ) {
+                Hamilton::tetm_neighbours_padded( hamilton_regular_plus, hamilton_cross_minus, wf_plus, i, col, p.N_x, p.dx, p.dy, p.periodic_boundary_x, -0.5 );
+                Hamilton::tetm_neighbours_padded( hamilton_regular_minus, hamilton_cross_plus, wf_minus, i, col, p.N_x, p.dx, p.dy, p.periodic_boundary_x, 0.5 );
+            } else {
+                Hamilton::tetm_neighbours_plus( hamilton_regular_plus, hamilton_cross_minus, wf_plus, i, row, col, p.N_x, p.N_y, p.dx, p.dy, p.periodic_boundary_x, p.periodic_boundary_y );
+                Hamilton::tetm_neighbours_minus( hamilton_regular_minus, hamilton_cross_plus, wf_minus, i, row, col, p.N_x, p.N_y, p.dx, p.dy, p.periodic_boundary_x, p.periodic_boundary_y );
+            }
+        }
+
+        const Type::real in_psi_plus_norm = CUDA::abs2( in_wf_plus );
+        const Type::real in_psi_minus_norm = CUDA::abs2( in_wf_minus );
+ 
+        // MARK: Wavefunction Plus
+        Type::complex result = p.minus_i_over_h_bar_s * p.m_eff_scaled * hamilton_regular_plus;
+    
+        for (int k = 0; k < oscillation_potential.n; k++) {
+            const size_t offset = k * p.N_x * p.N_y;
+            const Type::complex potential = dev_ptrs.potential_plus[i+offset] * oscillation_potential.amp[k];
+            result += p.minus_i_over_h_bar_s * potential * in_wf_plus;
+        }
+
+        result += p.minus_i_over_h_bar_s * p.g_c * in_psi_plus_norm * in_wf_plus;
+        result += p.minus_i_over_h_bar_s * p.g_r * in_rv_plus * in_wf_plus;
+        result += Type::real(0.5) * p.R * in_rv_plus * in_wf_plus;
+        result -= Type::real(0.5)* p.gamma_c * in_wf_plus;
+
+        result += p.minus_i_over_h_bar_s * p.g_pm * in_psi_minus_norm * in_wf_plus;
+        result += p.minus_i_over_h_bar_s * p.delta_LT * hamilton_cross_plus;
+    
+        // MARK: Pulse Plus
+        for (int k = 0; k < oscillation_pulse.n; k++) {
+            const size_t offset = k * p.N_x * p.N_y;
+            const Type::complex pulse = dev_ptrs.pulse_plus[i+offset];
+            result += p.one_over_h_bar_s * pulse * oscillation_pulse.amp[k];
+        }
+
+        // MARK: Stochastic
+        if (p.stochastic_amplitude > 0.0) {
+            const Type::complex dw_over_dt = dev_ptrs.random_number[i] * CUDA::sqrt( ( p.R * in_rv_plus + p.gamma_c ) / (Type::real(4.0) * p.dV * p.dt) );
+            result -= p.minus_i_over_h_bar_s * p.g_c * in_wf_plus / p.dV - dw_over_dt;
+        }
+
+        k_wf_plus = result;
+
+        // MARK: Wavefunction Minus
+        result = p.minus_i_over_h_bar_s * p.m_eff_scaled * hamilton_regular_minus;
+    
+        for (int k = 0; k < oscillation_potential.n; k++) {
+            const size_t offset = k * p.N_x * p.N_y;
+            const Type::complex potential = dev_ptrs.potential_minus[i+offset] * oscillation_potential.amp[k];
+            result += p.minus_i_over_h_bar_s * potential * in_wf_minus;
+        }
+
+        result += p.minus_i_over_h_bar_s * p.g_c * in_psi_minus_norm * in_wf_minus;
+        result += p.minus_i_over_h_bar_s * p.g_r * in_rv_minus * in_wf_minus;
+        result += Type::real(0.5) * p.R * in_rv_minus * in_wf_minus;
+        result -= Type::real(0.5) * p.gamma_c * in_wf_minus;
+ 
+        result += p.minus_i_over_h_bar_s * p.g_pm * in_psi_plus_norm * in_wf_minus;
+        result += p.minus_i_over_h_bar_s * p.delta_LT * hamilton_cross_minus;
+
+        // MARK: Pulse Minus
+        for (int k = 0; k < oscillation_pulse.n; k++) {
+            const size_t offset = k * p.N_x * p.N_y;
+            const Type::complex pulse = dev_ptrs.pulse_minus[i+offset];
+            result += p.one_over_h_bar_s * pulse * oscillation_pulse.amp[k];
+        }
+
+        if (p.stochastic_amplitude > 0.0) {
+            const Type::complex dw_over_dt = dev_ptrs.random_number[i] * CUDA::sqrt( ( p.R * in_rv_minus + p.gamma_c ) / (Type::real(4.0) * p.dV * p.dt) );
+            result -= p.minus_i_over_h_bar_s * p.g_c * in_wf_minus / p.dV - dw_over_dt;
+        }
+
+        k_wf_minus = result;
+        k_rv_plus = 0.0;
+        k_rv_minus = 0.0;
+        if ( not with_reservoir )
+            return;
+
+        // MARK: Reservoir Plus
+        result = -( p.gamma_r + p.R * in_psi_plus_norm ) * in_rv_plus;
+
+        for (int k = 0; k < oscillation_pump.n; k++) {
+            const size_t offset = k * p.N_x * p.N_y;
+            const auto gauss = oscillation_pump.amp[k];
+            result += dev_ptrs.pump_plus[i+offset] * gauss;
+        }
+
+        // MARK: Stochastic-2
+        if (p.stochastic_amplitude > 0.0)
+            result += p.R * in_rv_plus / p.dV;
+
+        k_rv_plus = result;
+
+        // MARK: Reservoir Minus
+        result = -( p.gamma_r + p.R * in_psi_minus_norm ) * in_rv_minus;
+
+        for (int k = 0; k < oscillation_pump.n; k++) {
+            const size_t offset = k * p.N_x * p.N_y;
+            const auto gauss = oscillation_pump.amp[k];
+            result += dev_ptrs.pump_minus[i+offset] * gauss;
+        }
+
+        // MARK: Stochastic-2
+        if (p.stochastic_amplitude > 0.0)
+            result += p.R * in_rv_minus / p.dV;
+
+        k_rv_minus = result;
+    }
+
+    // Evaluates the right hand side K of the TE/TM model at index i from the state io.in
+    PULSE_DEVICE PULSE_INLINE void gp_tetm_rhs( int i, MatrixContainer::Pointers& dev_ptrs, SystemParameters::KernelParameters& p, Solver::TemporalEvelope::Pointers& oscillation_pulse, Solver::TemporalEvelope::Pointers& oscillation_pump, Solver::TemporalEvelope::Pointers& oscillation_potential, InputOutput& io, Type::complex& k_wf_plus, Type::complex& k_wf_minus, Type::complex& k_rv_plus, Type::complex& k_rv_minus ) {
+        gp_tetm_rhs( i, dev_ptrs, p, oscillation_pulse, oscillation_pump, oscillation_potential, io.in_wf_plus, io.in_wf_minus, io.in_rv_plus[i], io.in_rv_minus[i], k_wf_plus, k_wf_minus, k_rv_plus, k_rv_minus );
+    }
+
+} // namespace PC3::Kernel::Compute
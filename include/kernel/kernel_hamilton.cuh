@@ -78,54 +78,33 @@ PULSE_DEVICE PULSE_INLINE Type::complex right_neighbour_periodic( Type::complex*
     return vector[index + distance];
 }
 
-// Special top-right, top-left, bottom-right and bottom-left periodic boundary conditions that honour the periodicity of the grid
-PULSE_DEVICE PULSE_INLINE Type::complex upper_right_neighbour_periodic( Type::complex* vector, int index, const int row, const int col, const int distance, const int N_x, const int N_y ) {
-    if ( is_valid_index( row - distance, col + distance, N_x, N_y ) )
-        // Valid upper neighbour
-        return vector[index - N_x * distance + distance];
-    // Check if we need to wrap around the rows
-    if ( is_valid_index( row - distance, col, N_x, N_y ) )
-        index += N_x*N_y - N_x * distance;
-    // Check if we need to wrap around the columns
-    if ( is_valid_index( row, col + distance, N_x, N_y ) )
-        index += distance - N_x;
-    return vector[index];
-}
-PULSE_DEVICE PULSE_INLINE Type::complex upper_left_neighbour_periodic( Type::complex* vector, int index, const int row, const int col, const int distance, const int N_x, const int N_y ) {
-    if ( is_valid_index( row - distance, col - distance, N_x, N_y ) )
-        // Valid upper neighbour
-        return vector[index - N_x * distance - distance];
-    // Check if we need to wrap around the rows
-    if ( is_valid_index( row - distance, col, N_x, N_y ) )
-        index += N_x*N_y - N_x * distance;
-    // Check if we need to wrap around the columns
-    if ( is_valid_index( row, col - distance, N_x, N_y ) )
-        index -= distance + N_x;
-    return vector[index];
-}
-PULSE_DEVICE PULSE_INLINE Type::complex lower_right_neighbour_periodic( Type::complex* vector, int index, const int row, const int col, const int distance, const int N_x, const int N_y ) {
-    if ( is_valid_index( row + distance, col + distance, N_x, N_y ) )
-        // Valid upper neighbour
-        return vector[index + N_x * distance + distance];
-    // Check if we need to wrap around the rows
-    if ( is_valid_index( row + distance, col, N_x, N_y ) )
-        index += N_x * distance - N_x*N_y;
-    // Check if we need to wrap around the columns
-    if ( is_valid_index( row, col + distance, N_x, N_y ) )
-        index += distance + N_x;
-    return vector[index];
-}
-PULSE_DEVICE PULSE_INLINE Type::complex lower_left_neighbour_periodic( Type::complex* vector, int index, const int row, const int col, const int distance, const int N_x, const int N_y ) {
-    if ( is_valid_index( row + distance, col - distance, N_x, N_y ) )
-        // Valid upper neighbour
-        return vector[index + N_x * distance - distance];
-    // Check if we need to wrap around the rows
-    if ( is_valid_index( row + distance, col, N_x, N_y ) )
-        index += N_x * distance - N_x*N_y;
-    // Check if we need to wrap around the columns
-    if ( is_valid_index( row, col - distance, N_x, N_y ) )
-        index -= distance + N_x;
-    return vector[index];
+/**
+ * Diagonal neighbour at a distance of row_distance rows and col_distance columns. Each direction
+ * is periodic or zero on its own, depending on periodic_x and periodic_y.
+*/
+PULSE_DEVICE PULSE_INLINE Type::complex diagonal_neighbour( Type::complex* vector, int row, int col, const int row_distance, const int col_distance, const int N_x, const int N_y, const bool periodic_x, const bool periodic_y ) {
+    row += row_distance;
+    col += col_distance;
+    if ( periodic_y )
+        row = ( row + N_y ) % N_y;
+    if ( periodic_x )
+        col = ( col + N_x ) % N_x;
+    if ( !is_valid_index( row, col, N_x, N_y ) )
+        return { 0.0, 0.0 };
+    return vector[row * N_x + col];
+}
+
+/**
+ * Halo padded matrices.
+ * The matrix is padded by two rows in front of and behind the grid, see MatrixContainer. The halo is
+ * either zero or holds the opposite rows of the grid, so the neighbours in y are read without checks.
+ * The neighbours in x are loaded unconditionally and selected, which may also read from the halo.
+*/
+PULSE_DEVICE PULSE_INLINE Type::complex neighbour_padded( Type::complex* vector, int index, const int col, const int row_distance, const int col_distance, const int N_x, const bool periodic_x ) {
+    const int wrap = col + col_distance < 0 ? N_x : ( col + col_distance >= N_x ? -N_x : 0 );
+    const Type::complex inner = vector[index + N_x * row_distance + col_distance];
+    const Type::complex wrapped = vector[index + N_x * row_distance + col_distance + wrap];
+    return wrap == 0 ? inner : ( periodic_x ? wrapped : Type::complex( 0.0, 0.0 ) );
 }
 
 PULSE_DEVICE PULSE_INLINE Type::complex scalar_neighbours( Type::complex* __restrict__ vector, int index, const int row, const int col, const int N_x, const int N_y, const Type::real one_over_dx2, const Type::real one_over_dy2, const bool periodic_x, const bool periodic_y ) {
@@ -152,10 +131,10 @@ PULSE_DEVICE PULSE_INLINE void tetm_neighbours_plus( Type::complex& regular, Typ
     }
     if (periodic_x) {
         horizontal = left_neighbour_periodic( vector, index, row, col, 1, N_x, N_y ) + right_neighbour_periodic( vector, index, row, col, 1, N_x, N_y );
-        cross = horizontal/dx/dx - vertical/dy/dy + Type::complex(0.0,-0.5)/dx/dy * ( -lower_right_neighbour_periodic( vector, index, row, col, 1, N_x, N_y ) + lower_left_neighbour_periodic( vector, index, row, col, 1, N_x, N_y ) + upper_right_neighbour_periodic( vector, index, row, col, 1, N_x, N_y ) - upper_left_neighbour_periodic( vector, index, row, col, 1, N_x, N_y ) );
+        cross = horizontal/dx/dx - vertical/dy/dy + Type::complex(0.0,-0.5)/dx/dy * ( -diagonal_neighbour( vector, row, col, 1, 1, N_x, N_y, periodic_x, periodic_y ) + diagonal_neighbour( vector, row, col, 1, -1, N_x, N_y, periodic_x, periodic_y ) + diagonal_neighbour( vector, row, col, -1, 1, N_x, N_y, periodic_x, periodic_y ) - diagonal_neighbour( vector, row, col, -1, -1, N_x, N_y, periodic_x, periodic_y ) );
     } else {
         horizontal = left_neighbour( vector, index, row, col, 1, N_x, N_y ) + right_neighbour( vector, index, row, col, 1, N_x, N_y );
-        cross = horizontal/dx/dx - vertical/dy/dy + Type::complex(0.0,-0.5)/dx/dy * ( -right_neighbour( vector, index - N_x, row - 1, col, 1, N_x, N_y ) + left_neighbour( vector, index - N_x, row - 1, col, 1, N_x, N_y ) + right_neighbour( vector, index + N_x, row + 1, col, 1, N_x, N_y ) - left_neighbour( vector, index + N_x, row + 1, col, 1, N_x, N_y ) );
+        cross = horizontal/dx/dx - vertical/dy/dy + Type::complex(0.0,-0.5)/dx/dy * ( -diagonal_neighbour( vector, row, col, -1, 1, N_x, N_y, periodic_x, periodic_y ) + diagonal_neighbour( vector, row, col, -1, -1, N_x, N_y, periodic_x, periodic_y ) + diagonal_neighbour( vector, row, col, 1, 1, N_x, N_y, periodic_x, periodic_y ) - diagonal_neighbour( vector, row, col, 1, -1, N_x, N_y, periodic_x, periodic_y ) );
     }
     regular += vertical/dy/dy + horizontal/dx/dx;
 }
@@ -169,10 +148,32 @@ PULSE_DEVICE PULSE_INLINE void tetm_neighbours_minus( Type::complex& regular, Ty
     }
     if (periodic_x) {
         horizontal = left_neighbour_periodic( vector, index, row, col, 1, N_x, N_y ) + right_neighbour_periodic( vector, index, row, col, 1, N_x, N_y );
-        cross = horizontal/dx/dx - vertical/dy/dy + Type::complex(0.0,0.5)/dx/dy * ( -lower_right_neighbour_periodic( vector, index, row, col, 1, N_x, N_y ) + lower_left_neighbour_periodic( vector, index, row, col, 1, N_x, N_y ) + upper_right_neighbour_periodic( vector, index, row, col, 1, N_x, N_y ) - upper_left_neighbour_periodic( vector, index, row, col, 1, N_x, N_y ) );
+        cross = horizontal/dx/dx - vertical/dy/dy + Type::complex(0.0,0.5)/dx/dy * ( -diagonal_neighbour( vector, row, col, 1, 1, N_x, N_y, periodic_x, periodic_y ) + diagonal_neighbour( vector, row, col, 1, -1, N_x, N_y, periodic_x, periodic_y ) + diagonal_neighbour( vector, row, col, -1, 1, N_x, N_y, periodic_x, periodic_y ) - diagonal_neighbour( vector, row, col, -1, -1, N_x, N_y, periodic_x, periodic_y ) );
     } else {
         horizontal = left_neighbour( vector, index, row, col, 1, N_x, N_y ) + right_neighbour( vector, index, row, col, 1, N_x, N_y );
-        cross = horizontal/dx/dx - vertical/dy/dy + Type::complex(0.0,0.5)/dx/dy * ( -right_neighbour( vector, index - N_x, row - 1, col, 1, N_x, N_y ) + left_neighbour( vector, index - N_x, row - 1, col, 1, N_x, N_y ) + right_neighbour( vector, index + N_x, row + 1, col, 1, N_x, N_y ) - left_neighbour( vector, index + N_x, row + 1, col, 1, N_x, N_y ) );
+        cross = horizontal/dx/dx - vertical/dy/dy + Type::complex(0.0,0.5)/dx/dy * ( -diagonal_neighbour( vector, row, col, -1, 1, N_x, N_y, periodic_x, periodic_y ) + diagonal_neighbour( vector, row, col, -1, -1, N_x, N_y, periodic_x, periodic_y ) + diagonal_neighbour( vector, row, col, 1, 1, N_x, N_y, periodic_x, periodic_y ) - diagonal_neighbour( vector, row, col, 1, -1, N_x, N_y, periodic_x, periodic_y ) );
+    }
+    regular += vertical/dy/dy + horizontal/dx/dx;
+}
+
+PULSE_DEVICE PULSE_INLINE Type::complex scalar_neighbours_padded( Type::complex* __restrict__ vector, int index, const int col, const int N_x, const Type::real one_over_dx2, const Type::real one_over_dy2, const bool periodic_x ) {
+    const Type::complex horizontal = neighbour_padded( vector, index, col, 0, -1, N_x, periodic_x ) + neighbour_padded( vector, index, col, 0, 1, N_x, periodic_x );
+    const Type::complex vertical = vector[index - N_x] + vector[index + N_x];
+    return vertical*one_over_dy2 + horizontal*one_over_dx2;
+}
+
+// Padded version of tetm_neighbours_plus (sign = -0.5) and tetm_neighbours_minus (sign = 0.5)
+PULSE_DEVICE PULSE_INLINE void tetm_neighbours_padded( Type::complex& regular, Type::complex& cross, Type::complex* __restrict__ vector, int index, const int col, const int N_x, const Type::real dx, const Type::real dy, const bool periodic_x, const Type::real sign ) {
+    const Type::complex vertical = vector[index - N_x] + vector[index + N_x];
+    const Type::complex horizontal = neighbour_padded( vector, index, col, 0, -1, N_x, periodic_x ) + neighbour_padded( vector, index, col, 0, 1, N_x, periodic_x );
+    const Type::complex upper_right = neighbour_padded( vector, index, col, -1, 1, N_x, periodic_x );
+    const Type::complex upper_left = neighbour_padded( vector, index, col, -1, -1, N_x, periodic_x );
+    const Type::complex lower_right = neighbour_padded( vector, index, col, 1, 1, N_x, periodic_x );
+    const Type::complex lower_left = neighbour_padded( vector, index, col, 1, -1, N_x, periodic_x );
+    if (periodic_x) {
+        cross = horizontal/dx/dx - vertical/dy/dy + Type::complex(0.0,sign)/dx/dy * ( -lower_right + lower_left + upper_right - upper_left );
+    } else {
+        cross = horizontal/dx/dx - vertical/dy/dy + Type::complex(0.0,sign)/dx/dy * ( -upper_right + upper_left + lower_right - lower_left );
     }
     regular += vertical/dy/dy + horizontal/dx/dx;
 }
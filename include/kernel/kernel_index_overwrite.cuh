@@ -8,6 +8,9 @@ namespace PC3::Kernel {
     #define OVERWRITE_THREAD_INDEX( i ) \
         i += blockIdx.x * blockDim.x + threadIdx.x; \
         if (i >= p.N2) return;
+    // Overwrites the index without returning, for kernels in which all threads of a block have to participate in a reduction.
+    #define OVERWRITE_THREAD_INDEX_NO_RETURN( i ) \
+        i += blockIdx.x * blockDim.x + threadIdx.x;
     #define GENERATE_THREAD_INDEX( N ) \
         int i = blockIdx.x * blockDim.x + threadIdx.x; \
         if (i >= N) return;
@@ -25,6 +28,7 @@ namespace PC3::Kernel {
 
     // Else the macro is empty.
     #define OVERWRITE_THREAD_INDEX( i )
+    #define OVERWRITE_THREAD_INDEX_NO_RETURN( i )
     #define GENERATE_THREAD_INDEX( N ) \
         int i = 0;
     #define GET_THREAD_INDEX( i, N )
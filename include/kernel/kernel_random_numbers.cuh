@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <cmath>
+#include "cuda/typedef.cuh"
+
+/*
+ * Stateless counter based random number generator. Philox4x32-10 (Salmon et al., "Parallel random
+ * numbers: as easy as 1, 2, 3", 2011) maps a 128 bit counter and a 64 bit key to four independent
+ * 32 bit random numbers. The key is the seed and the counter consists of the grid index, the step
+ * and a stream index, so the random numbers of a grid point only depend on (seed, step, stream, index).
+ * No generator state has to be stored and the numbers do not depend on the number of threads, the
+ * order of evaluation or whether the CPU or the GPU is used.
+ */
+namespace PC3::Kernel::Random {
+
+struct Philox4x32 {
+    uint32_t x[4];
+};
+
+// High and low 32 bits of the 64 bit product a * b
+PULSE_HOST_DEVICE PULSE_INLINE void mulhilo( const uint32_t a, const uint32_t b, uint32_t& hi, uint32_t& lo ) {
+    const uint64_t product = uint64_t( a ) * uint64_t( b );
+    hi = uint32_t( product >> 32 );
+    lo = uint32_t( product );
+}
+
+// Ten rounds of Philox4x32 for the counter (index, step, stream, 0) and the key (seed, 0)
+PULSE_HOST_DEVICE PULSE_INLINE Philox4x32 philox4x32( const uint32_t index, const uint32_t step, const uint32_t stream, const uint32_t seed ) {
+    uint32_t c0 = index, c1 = step, c2 = stream, c3 = 0;
+    uint32_t k0 = seed, k1 = 0;
+    for ( int round = 0; round < 10; round++ ) {
+        uint32_t hi0, lo0, hi1, lo1;
+        mulhilo( 0xD2511F53u, c0, hi0, lo0 );
+        mulhilo( 0xCD9E8D57u, c2, hi1, lo1 );
+        c0 = hi1 ^ c1 ^ k0;
+        c1 = lo1;
+        c2 = hi0 ^ c3 ^ k1;
+        c3 = lo0;
+        k0 += 0x9E3779B9u;
+        k1 += 0xBB67AE85u;
+    }
+    return { { c0, c1, c2, c3 } };
+}
+
+// Uniform random numbers in (0, 1). Double precision uses two 32 bit numbers for the 53 bit mantissa.
+PULSE_HOST_DEVICE PULSE_INLINE float uniform( const uint32_t x ) {
+    return ( float( x >> 8 ) + 0.5f ) * ( 1.0f / 16777216.0f );
+}
+PULSE_HOST_DEVICE PULSE_INLINE double uniform( const uint32_t x, const uint32_t y ) {
+    return ( double( ( uint64_t( x ) << 21 ) ^ ( y >> 11 ) ) + 0.5 ) * ( 1.0 / 9007199254740992.0 );
+}
+
+/**
+ * Two independent standard normal random numbers, returned as the real and imaginary part, using
+ * the Box-Muller transform. The transform is branch free, so the CPU loop over a row vectorizes.
+ */
+PULSE_HOST_DEVICE PULSE_INLINE Type::complex normal_pair( const uint32_t index, const uint32_t step, const uint32_t stream, const uint32_t seed ) {
+    const Philox4x32 r = philox4x32( index, step, stream, seed );
+    Type::real u1, u2;
+    if constexpr ( sizeof( Type::real ) == sizeof( double ) ) {
+        u1 = Type::real( uniform( r.x[0], r.x[1] ) );
+        u2 = Type::real( uniform( r.x[2], r.x[3] ) );
+    } else {
+        u1 = Type::real( uniform( r.x[0] ) );
+        u2 = Type::real( uniform( r.x[1] ) );
+    }
+    const Type::real radius = std::sqrt( Type::real( -2.0 ) * std::log( u1 ) );
+    const Type::real angle = Type::real( 6.283185307179586 ) * u2;
+    return { radius * std::cos( angle ), radius * std::sin( angle ) };
+}
+
+} // namespace PC3::Kernel::Random
@@ -0,0 +1,447 @@
+#pragma once
+#include "cuda/typedef.cuh"
+#include "kernel/kernel_compute.cuh"
+#include "kernel/kernel_gp_rhs.cuh"
+#include "kernel/kernel_index_overwrite.cuh"
+#include "kernel/kernel_runge_kutta_tableau.cuh"
+
+/*
+ * Fused Runge-Kutta stage kernels generated from a Butcher tableau. The stage index and the
+ * tableau are template parameters, so all weights are compile time constants. The weighted
+ * sums are fully unrolled and Ks with zero weights are never read.
+ */
+namespace PC3::Kernel::RK {
+
+// Wavefunction and reservoir matrices of a K matrix slot or a stage input location
+template <int location>
+PULSE_HOST_DEVICE PULSE_INLINE Type::complex* wavefunction_at( MatrixContainer::Pointers& dev_ptrs, const bool minus ) {
+    static_assert( location >= Tableau::buffer and location < 10, "Tableaus can use at most 10 K matrices" );
+    if constexpr ( location == Tableau::wavefunction ) return minus ? dev_ptrs.wavefunction_minus : dev_ptrs.wavefunction_plus;
+    else if constexpr ( location == Tableau::buffer ) return minus ? dev_ptrs.buffer_wavefunction_minus : dev_ptrs.buffer_wavefunction_plus;
+    else if constexpr ( location == 0 ) return minus ? dev_ptrs.k1_wavefunction_minus : dev_ptrs.k1_wavefunction_plus;
+    else if constexpr ( location == 1 ) return minus ? dev_ptrs.k2_wavefunction_minus : dev_ptrs.k2_wavefunction_plus;
+    else if constexpr ( location == 2 ) return minus ? dev_ptrs.k3_wavefunction_minus : dev_ptrs.k3_wavefunction_plus;
+    else if constexpr ( location == 3 ) return minus ? dev_ptrs.k4_wavefunction_minus : dev_ptrs.k4_wavefunction_plus;
+    else if constexpr ( location == 4 ) return minus ? dev_ptrs.k5_wavefunction_minus : dev_ptrs.k5_wavefunction_plus;
+    else if constexpr ( location == 5 ) return minus ? dev_ptrs.k6_wavefunction_minus : dev_ptrs.k6_wavefunction_plus;
+    else if constexpr ( location == 6 ) return minus ? dev_ptrs.k7_wavefunction_minus : dev_ptrs.k7_wavefunction_plus;
+    else if constexpr ( location == 7 ) return minus ? dev_ptrs.k8_wavefunction_minus : dev_ptrs.k8_wavefunction_plus;
+    else if constexpr ( location == 8 ) return minus ? dev_ptrs.k9_wavefunction_minus : dev_ptrs.k9_wavefunction_plus;
+    else return minus ? dev_ptrs.k10_wavefunction_minus : dev_ptrs.k10_wavefunction_plus;
+}
+template <int location>
+PULSE_DEVICE PULSE_INLINE Type::complex* reservoir_at( MatrixContainer::Pointers& dev_ptrs, const bool minus ) {
+    static_assert( location >= Tableau::buffer and location < 10, "Tableaus can use at most 10 K matrices" );
+    if constexpr ( location == Tableau::wavefunction ) return minus ? dev_ptrs.reservoir_minus : dev_ptrs.reservoir_plus;
+    else if constexpr ( location == Tableau::buffer ) return minus ? dev_ptrs.buffer_reservoir_minus : dev_ptrs.buffer_reservoir_plus;
+    else if constexpr ( location == 0 ) return minus ? dev_ptrs.k1_reservoir_minus : dev_ptrs.k1_reservoir_plus;
+    else if constexpr ( location == 1 ) return minus ? dev_ptrs.k2_reservoir_minus : dev_ptrs.k2_reservoir_plus;
+    else if constexpr ( location == 2 ) return minus ? dev_ptrs.k3_reservoir_minus : dev_ptrs.k3_reservoir_plus;
+    else if constexpr ( location == 3 ) return minus ? dev_ptrs.k4_reservoir_minus : dev_ptrs.k4_reservoir_plus;
+    else if constexpr ( location == 4 ) return minus ? dev_ptrs.k5_reservoir_minus : dev_ptrs.k5_reservoir_plus;
+    else if constexpr ( location == 5 ) return minus ? dev_ptrs.k6_reservoir_minus : dev_ptrs.k6_reservoir_plus;
+    else if constexpr ( location == 6 ) return minus ? dev_ptrs.k7_reservoir_minus : dev_ptrs.k7_reservoir_plus;
+    else if constexpr ( location == 7 ) return minus ? dev_ptrs.k8_reservoir_minus : dev_ptrs.k8_reservoir_plus;
+    else if constexpr ( location == 8 ) return minus ? dev_ptrs.k9_reservoir_minus : dev_ptrs.k9_reservoir_plus;
+    else return minus ? dev_ptrs.k10_reservoir_minus : dev_ptrs.k10_reservoir_plus;
+}
+
+// Adds weight(row, n) * K_n for the stored Ks n = N ... n_end - 1. Zero weights are skipped at compile time.
+// The reservoir Ks are only summed if with_reservoir is set.
+template <class T, int row, int n_end, bool with_reservoir = true, int N = 0>
+PULSE_DEVICE PULSE_INLINE void sum_stored_ks( int i, MatrixContainer::Pointers& dev_ptrs, const bool minus, Type::complex& wf, Type::complex& rv ) {
+    if constexpr ( N < n_end ) {
+        constexpr double w = Tableau::weight<T>( row, N );
+        if constexpr ( w != 0.0 ) {
+            static_assert( Tableau::is_stored<T>( N ), "A K with nonzero weight has to be stored" );
+            constexpr int slot = Tableau::k_slot<T>( N );
+            wf += Type::real( w ) * wavefunction_at<slot>( dev_ptrs, minus )[i];
+            if constexpr ( with_reservoir )
+                rv += Type::real( w ) * reservoir_at<slot>( dev_ptrs, minus )[i];
+        }
+        sum_stored_ks<T, row, n_end, with_reservoir, N + 1>( i, dev_ptrs, minus, wf, rv );
+    }
+}
+
+// Parameters of the error norm of adaptive tableaus. The squared local errors are scaled by atol + rtol * max(|current|, |next|)
+// and reduced into partial_sums by the last stage. The reservoir is only included if with_reservoir is set.
+struct ErrorNorm {
+    Type::real* partial_sums = nullptr;
+    Type::real atol = 0.0;
+    Type::real rtol = 0.0;
+    bool with_reservoir = false;
+};
+
+// Squared local error scaled by the tolerances. Points without any weight do not contribute.
+PULSE_DEVICE PULSE_INLINE Type::real scaled_error( const Type::complex error, const Type::complex current, const Type::complex next, const ErrorNorm& norm ) {
+    const Type::real abs_current = CUDA::abs( current );
+    const Type::real abs_next = CUDA::abs( next );
+    const Type::real scale = norm.atol + norm.rtol * ( abs_current > abs_next ? abs_current : abs_next );
+    return scale > 0.0 ? CUDA::abs2( error ) / ( scale * scale ) : 0.0;
+}
+
+/**
+ * Processes K_S of a single component. Stores K_S if a later stage requires it, writes the input
+ * of stage S+1 and, without FSAL, accumulates the final sum in the buffer. The last stage of an
+ * adaptive tableau returns the scaled squared local error dt * sum_n e_n * K_n, see ErrorNorm.
+ * The last K of an FSAL tableau is stored in the FSAL slot. If store is false, K_S is already stored.
+ * If with_reservoir is false, only the wavefunction is processed, see multi_rate_reservoir.
+ */
+template <class T, int S, bool store = true>
+PULSE_DEVICE PULSE_INLINE Type::real tableau_stage_sum( int i, Type::complex dt, MatrixContainer::Pointers& dev_ptrs, const Type::complex k_wf, const Type::complex k_rv, const bool minus, const bool with_reservoir, const ErrorNorm& norm = {} ) {
+    constexpr int last = T::stages - 1;
+    Type::complex* current_wf = wavefunction_at<Tableau::wavefunction>( dev_ptrs, minus );
+    Type::complex* current_rv = reservoir_at<Tableau::wavefunction>( dev_ptrs, minus );
+
+    if constexpr ( store and Tableau::is_stored<T>( S ) ) {
+        constexpr int slot = Tableau::k_slot<T>( S );
+        wavefunction_at<slot>( dev_ptrs, minus )[i] = k_wf;
+        if ( with_reservoir )
+            reservoir_at<slot>( dev_ptrs, minus )[i] = k_rv;
+    }
+    if constexpr ( T::fsal and S == last ) {
+        constexpr int slot = Tableau::fsal_slot<T>();
+        wavefunction_at<slot>( dev_ptrs, minus )[i] = k_wf;
+        if ( with_reservoir )
+            reservoir_at<slot>( dev_ptrs, minus )[i] = k_rv;
+    }
+
+    if constexpr ( S < last ) {
+        constexpr double w = Tableau::weight<T>( S + 1, S );
+        constexpr int next = Tableau::input_location<T>( S + 1 );
+        Type::complex wf = Type::real( w ) * k_wf;
+        Type::complex rv = Type::real( w ) * k_rv;
+        if ( with_reservoir ) {
+            sum_stored_ks<T, S + 1, S>( i, dev_ptrs, minus, wf, rv );
+            reservoir_at<next>( dev_ptrs, minus )[i] = current_rv[i] + dt * rv;
+        } else {
+            sum_stored_ks<T, S + 1, S, false>( i, dev_ptrs, minus, wf, rv );
+        }
+        wavefunction_at<next>( dev_ptrs, minus )[i] = current_wf[i] + dt * wf;
+    }
+
+    if constexpr ( not T::fsal ) {
+        constexpr double w = Tableau::weight<T>( Tableau::final_row, S );
+        Type::complex* final_wf = wavefunction_at<Tableau::buffer>( dev_ptrs, minus );
+        Type::complex* final_rv = reservoir_at<Tableau::buffer>( dev_ptrs, minus );
+        if constexpr ( S == 0 ) {
+            final_wf[i] = current_wf[i] + dt * Type::real( w ) * k_wf;
+            if ( with_reservoir )
+                final_rv[i] = current_rv[i] + dt * Type::real( w ) * k_rv;
+        } else if constexpr ( w != 0.0 ) {
+            final_wf[i] += dt * Type::real( w ) * k_wf;
+            if ( with_reservoir )
+                final_rv[i] += dt * Type::real( w ) * k_rv;
+        }
+    }
+
+    if constexpr ( T::adaptive and S == last ) {
+        constexpr double w = Tableau::weight<T>( Tableau::error_row, S );
+        Type::complex wf = Type::real( w ) * k_wf;
+        Type::complex rv = Type::real( w ) * k_rv;
+        Type::complex* final_wf = wavefunction_at<Tableau::buffer>( dev_ptrs, minus );
+        Type::complex* final_rv = reservoir_at<Tableau::buffer>( dev_ptrs, minus );
+        if ( not norm.with_reservoir ) {
+            sum_stored_ks<T, Tableau::error_row, S, false>( i, dev_ptrs, minus, wf, rv );
+            return scaled_error( dt * wf, current_wf[i], final_wf[i], norm );
+        }
+        sum_stored_ks<T, Tableau::error_row, S>( i, dev_ptrs, minus, wf, rv );
+        return scaled_error( dt * wf, current_wf[i], final_wf[i], norm ) + scaled_error( dt * rv, current_rv[i], final_rv[i], norm );
+    }
+    return 0.0;
+}
+
+// Values reduced by the last stage of an adaptive tableau: the scaled squared errors of all components
+constexpr int error_sum = 0;
+constexpr int n_reduced = 1;
+
+// Number of partial sums per reduced value. One per block on the GPU and one per row on the CPU.
+PULSE_HOST_DEVICE PULSE_INLINE int partial_sum_count( const unsigned int N_y, const unsigned int n_blocks ) {
+#ifdef USE_CUDA
+    return n_blocks;
+#else
+    return N_y;
+#endif
+}
+
+/**
+ * Adds the values of this thread to the partial sums partial_sums[v * n_partial + b] with n_partial
+ * given by partial_sum_count. On the GPU, the values are summed over the warps using shuffles and
+ * then over the block, and the first thread of block b writes the partial sums. All threads of the
+ * block have to call this function. On the CPU, a row is always processed by a single thread from
+ * left to right, so row b accumulates its own partial sums without any synchronization.
+ */
+PULSE_DEVICE PULSE_INLINE void reduce_partial_sums( int i, SystemParameters::KernelParameters& p, Type::real* partial_sums, Type::real ( &values )[n_reduced] ) {
+#ifdef USE_CUDA
+    __shared__ Type::real warp_sums[n_reduced][32];
+    const int lane = threadIdx.x % 32;
+    const int warp = threadIdx.x / 32;
+    for ( int v = 0; v < n_reduced; v++ ) {
+        for ( int offset = 16; offset > 0; offset /= 2 )
+            values[v] += __shfl_down_sync( 0xffffffff, values[v], offset );
+        if ( lane == 0 )
+            warp_sums[v][warp] = values[v];
+    }
+    __syncthreads();
+    if ( threadIdx.x != 0 )
+        return;
+    const int n_partial = partial_sum_count( p.N_y, gridDim.x );
+    for ( int v = 0; v < n_reduced; v++ ) {
+        Type::real sum = 0.0;
+        for ( int w = 0; w < ( blockDim.x + 31 ) / 32; w++ )
+            sum += warp_sums[v][w];
+        partial_sums[v * n_partial + blockIdx.x] = sum;
+    }
+#else
+    const int row = i / p.N_x;
+    const int n_partial = partial_sum_count( p.N_y, 0 );
+    for ( int v = 0; v < n_reduced; v++ ) {
+        if ( i % p.N_x == 0 )
+            partial_sums[v * n_partial + row] = values[v];
+        else
+            partial_sums[v * n_partial + row] += values[v];
+    }
+#endif
+}
+
+// Reduces the scaled squared difference of the step doubling iterators into norm.partial_sums. K3 holds the
+// coarse result, the wavefunction the current and the buffer the next (fine) state.
+PULSE_GLOBAL void step_doubling_error( int i, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, ErrorNorm norm );
+
+/**
+ * Multi-rate mode. The reservoir equation dn/dt = P - Gamma n with Gamma = gamma_r + R |Psi|^2 is linear in n,
+ * so it is advanced once per step using its exact solution
+ * ------------------------------------------------------------------------------
+ * n(t + dt) = n(t) exp( -Gamma dt ) + P ( 1 - exp( -Gamma dt ) ) / Gamma
+ * ------------------------------------------------------------------------------
+ * with |Psi|^2 averaged between the current and the next wavefunction. This is the only exponential
+ * per step. The stage inputs use the linear interpolation n(t + tau) = n(t) + tau ( P - Gamma n(t) ),
+ * which agrees with the exact solution to first order in tau. The reservoir Ks and stage inputs are
+ * neither evaluated nor stored. The stochastic term R n / dV is included in Gamma.
+ */
+template <int location>
+PULSE_DEVICE PULSE_INLINE void multi_rate_rates( int i, MatrixContainer::Pointers& dev_ptrs, SystemParameters::KernelParameters& p, Solver::TemporalEvelope::Pointers& oscillation_pump, const bool minus, Type::complex& pump, Type::real& gamma ) {
+    Type::real psi_norm = CUDA::abs2( wavefunction_at<location>( dev_ptrs, minus )[i] );
+    if constexpr ( location != Tableau::wavefunction )
+        psi_norm = Type::real( 0.5 ) * ( psi_norm + CUDA::abs2( wavefunction_at<Tableau::wavefunction>( dev_ptrs, minus )[i] ) );
+    pump = 0.0;
+    for ( int k = 0; k < oscillation_pump.n; k++ )
+        pump += ( minus ? dev_ptrs.pump_minus : dev_ptrs.pump_plus )[i + k * p.N2] * oscillation_pump.amp[k];
+    gamma = p.gamma_r + p.R * psi_norm;
+    if ( p.stochastic_amplitude > 0.0 )
+        gamma -= p.R / p.dV;
+}
+
+// n exp( -Gamma tau ) + P ( 1 - exp( -Gamma tau ) ) / Gamma for a real or complex tau
+template <typename Scalar>
+PULSE_DEVICE PULSE_INLINE Type::complex multi_rate_update( const Type::complex rv, const Type::complex pump, const Type::real gamma, const Scalar tau ) {
+    const Scalar x = gamma * tau;
+    const Scalar decay = CUDA::exp( -x );
+    // ( 1 - exp( -x ) ) / Gamma is expanded for small x to avoid the cancellation
+    const Scalar phi = CUDA::abs( x ) > Type::real( 1E-2 ) ? ( Type::real( 1.0 ) - decay ) / gamma : tau * ( Type::real( 1.0 ) - x * ( Type::real( 0.5 ) - x / Type::real( 6.0 ) ) );
+    return rv * decay + pump * phi;
+}
+
+// Exact reservoir update over tau, using |Psi|^2 averaged between the current wavefunction and the one at location
+template <int location>
+PULSE_DEVICE PULSE_INLINE Type::complex multi_rate_reservoir( int i, Type::complex tau, MatrixContainer::Pointers& dev_ptrs, SystemParameters::KernelParameters& p, Solver::TemporalEvelope::Pointers& oscillation_pump, const bool minus ) {
+    Type::complex pump;
+    Type::real gamma;
+    multi_rate_rates<location>( i, dev_ptrs, p, oscillation_pump, minus, pump, gamma );
+    const Type::complex rv = reservoir_at<Tableau::wavefunction>( dev_ptrs, minus )[i];
+    // Only the imaginary time propagation requires the much more expensive complex exponential
+    if ( CUDA::imag( tau ) == 0.0 )
+        return multi_rate_update( rv, pump, gamma, CUDA::real( tau ) );
+    return multi_rate_update( rv, pump, gamma, tau );
+}
+
+// Reservoir of the input of stage S in the multi-rate mode. The last stage input of an FSAL tableau is the
+// next state, so its reservoir is the exact update of this step.
+template <class T, int S>
+PULSE_DEVICE PULSE_INLINE Type::complex multi_rate_stage_reservoir( int i, Type::complex dt, MatrixContainer::Pointers& dev_ptrs, SystemParameters::KernelParameters& p, Solver::TemporalEvelope::Pointers& oscillation_pump, const bool minus ) {
+    if constexpr ( T::c[S] == 0.0 ) {
+        return reservoir_at<Tableau::wavefunction>( dev_ptrs, minus )[i];
+    } else if constexpr ( T::fsal and S == T::stages - 1 ) {
+        return multi_rate_reservoir<Tableau::input_location<T>( S )>( i, dt, dev_ptrs, p, oscillation_pump, minus );
+    } else {
+        Type::complex pump;
+        Type::real gamma;
+        multi_rate_rates<Tableau::wavefunction>( i, dev_ptrs, p, oscillation_pump, minus, pump, gamma );
+        const Type::complex rv = reservoir_at<Tableau::wavefunction>( dev_ptrs, minus )[i];
+        return rv + Type::real( T::c[S] ) * dt * ( pump - gamma * rv );
+    }
+}
+
+// Writes the reservoir of the next state into the buffer after the last stage. The last stage input of an FSAL tableau already is the next state.
+template <class T>
+PULSE_DEVICE PULSE_INLINE void multi_rate_final_reservoir( int i, Type::complex dt, MatrixContainer::Pointers& dev_ptrs, SystemParameters::KernelParameters& p, Solver::TemporalEvelope::Pointers& oscillation_pump, const Type::complex stage_rv, const bool minus ) {
+    if constexpr ( T::fsal )
+        reservoir_at<Tableau::buffer>( dev_ptrs, minus )[i] = stage_rv;
+    else
+        reservoir_at<Tableau::buffer>( dev_ptrs, minus )[i] = multi_rate_reservoir<Tableau::buffer>( i, dt, dev_ptrs, p, oscillation_pump, minus );
+}
+
+// Evaluates K_S of the scalar model from the input of stage S and processes it using tableau_stage_sum
+template <class T, int S>
+PULSE_DEVICE PULSE_INLINE Type::real gp_scalar_stage( int i, Type::complex dt, MatrixContainer::Pointers& dev_ptrs, SystemParameters::KernelParameters& p, Solver::TemporalEvelope::Pointers& oscillation_pulse, Solver::TemporalEvelope::Pointers& oscillation_pump, Solver::TemporalEvelope::Pointers& oscillation_potential, const ErrorNorm& norm ) {
+    constexpr int input = Tableau::input_location<T>( S );
+    Type::complex k_wf, k_rv;
+    if ( not p.multi_rate ) {
+        Compute::gp_scalar_rhs( i, dev_ptrs, p, oscillation_pulse, oscillation_pump, oscillation_potential, wavefunction_at<input>( dev_ptrs, false ), reservoir_at<input>( dev_ptrs, false )[i], k_wf, k_rv );
+        return tableau_stage_sum<T, S>( i, dt, dev_ptrs, k_wf, k_rv, false, true, norm );
+    }
+    const Type::complex rv = multi_rate_stage_reservoir<T, S>( i, dt, dev_ptrs, p, oscillation_pump, false );
+    Compute::gp_scalar_rhs( i, dev_ptrs, p, oscillation_pulse, oscillation_pump, oscillation_potential, wavefunction_at<input>( dev_ptrs, false ), rv, k_wf, k_rv, false );
+    const Type::real error = tableau_stage_sum<T, S>( i, dt, dev_ptrs, k_wf, k_rv, false, false, norm );
+    if constexpr ( S == T::stages - 1 )
+        multi_rate_final_reservoir<T>( i, dt, dev_ptrs, p, oscillation_pump, rv, false );
+    return error;
+}
+
+// Evaluates K_S of the TE/TM model from the input of stage S and processes both components using tableau_stage_sum
+template <class T, int S>
+PULSE_DEVICE PULSE_INLINE Type::real gp_tetm_stage( int i, Type::complex dt, MatrixContainer::Pointers& dev_ptrs, SystemParameters::KernelParameters& p, Solver::TemporalEvelope::Pointers& oscillation_pulse, Solver::TemporalEvelope::Pointers& oscillation_pump, Solver::TemporalEvelope::Pointers& oscillation_potential, const ErrorNorm& norm ) {
+    constexpr int input = Tableau::input_location<T>( S );
+    Type::complex k_wf_plus, k_wf_minus, k_rv_plus, k_rv_minus;
+    if ( not p.multi_rate ) {
+        Compute::gp_tetm_rhs( i, dev_ptrs, p, oscillation_pulse, oscillation_pump, oscillation_potential, wavefunction_at<input>( dev_ptrs, false ), wavefunction_at<input>( dev_ptrs, true ), reservoir_at<input>( dev_ptrs, false )[i], reservoir_at<input>( dev_ptrs, true )[i], k_wf_plus, k_wf_minus, k_rv_plus, k_rv_minus );
+        return tableau_stage_sum<T, S>( i, dt, dev_ptrs, k_wf_plus, k_rv_plus, false, true, norm ) + tableau_stage_sum<T, S>( i, dt, dev_ptrs, k_wf_minus, k_rv_minus, true, true, norm );
+    }
+    const Type::complex rv_plus = multi_rate_stage_reservoir<T, S>( i, dt, dev_ptrs, p, oscillation_pump, false );
+    const Type::complex rv_minus = multi_rate_stage_reservoir<T, S>( i, dt, dev_ptrs, p, oscillation_pump, true );
+    Compute::gp_tetm_rhs( i, dev_ptrs, p, oscillation_pulse, oscillation_pump, oscillation_potential, wavefunction_at<input>( dev_ptrs, false ), wavefunction_at<input>( dev_ptrs, true ), rv_plus, rv_minus, k_wf_plus, k_wf_minus, k_rv_plus, k_rv_minus, false );
+    const Type::real error = tableau_stage_sum<T, S>( i, dt, dev_ptrs, k_wf_plus, k_rv_plus, false, false, norm ) + tableau_stage_sum<T, S>( i, dt, dev_ptrs, k_wf_minus, k_rv_minus, true, false, norm );
+    if constexpr ( S == T::stages - 1 ) {
+        multi_rate_final_reservoir<T>( i, dt, dev_ptrs, p, oscillation_pump, rv_plus, false );
+        multi_rate_final_reservoir<T>( i, dt, dev_ptrs, p, oscillation_pump, rv_minus, true );
+    }
+    return error;
+}
+
+// Adds d_n * K_n of the last step for n = N ... T::stages - 1. Zero weights are skipped at compile time.
+template <class T, int N = 0>
+PULSE_DEVICE PULSE_INLINE void sum_dense_ks( int i, MatrixContainer::Pointers& dev_ptrs, const bool minus, Type::complex& wf, Type::complex& rv ) {
+    if constexpr ( N < T::stages ) {
+        constexpr double w = Tableau::weight<T>( Tableau::dense_row, N );
+        if constexpr ( w != 0.0 ) {
+            constexpr int slot = Tableau::dense_slot<T>( N );
+            wf += Type::real( w ) * wavefunction_at<slot>( dev_ptrs, minus )[i];
+            rv += Type::real( w ) * reservoir_at<slot>( dev_ptrs, minus )[i];
+        }
+        sum_dense_ks<T, N + 1>( i, dev_ptrs, minus, wf, rv );
+    }
+}
+
+// Cubic Hermite interpolation between y0 and y1 with the derivatives f0 and f1 at theta in [0, 1]
+PULSE_DEVICE PULSE_INLINE Type::complex hermite_interpolation( const Type::real theta, const Type::complex dt, const Type::complex y0, const Type::complex y1, const Type::complex f0, const Type::complex f1 ) {
+    const Type::complex delta = y1 - y0;
+    const Type::complex r = dt * f0 - delta;
+    return y0 + theta * ( delta + ( Type::real( 1.0 ) - theta ) * ( r + theta * ( delta - dt * f1 - r ) ) );
+}
+
+/**
+ * Dense output of a single component at t0 + theta * dt within the last step from t0 to t0 + dt.
+ * The previous state is still located in the buffer. Without a continuous extension, the state is
+ * interpolated using the cubic Hermite interpolation with the right hand sides of both states. The
+ * continuous extension of the tableau adds the correction theta^2 (1 - theta)^2 dt * sum_n d_n * K_n,
+ * which has the same form for all extensions written in the form of Hairer, Norsett and Wanner.
+ */
+template <class T>
+PULSE_DEVICE PULSE_INLINE void dense_output( int i, const Type::real theta, Type::complex dt, MatrixContainer::Pointers& dev_ptrs, const bool minus ) {
+    constexpr int first = Tableau::dense_slot<T>( 0 );
+    constexpr int last = Tableau::dense_slot<T>( T::stages - 1 );
+    Type::complex wf = hermite_interpolation( theta, dt, wavefunction_at<Tableau::buffer>( dev_ptrs, minus )[i], wavefunction_at<Tableau::wavefunction>( dev_ptrs, minus )[i], wavefunction_at<first>( dev_ptrs, minus )[i], wavefunction_at<last>( dev_ptrs, minus )[i] );
+    Type::complex rv = hermite_interpolation( theta, dt, reservoir_at<Tableau::buffer>( dev_ptrs, minus )[i], reservoir_at<Tableau::wavefunction>( dev_ptrs, minus )[i], reservoir_at<first>( dev_ptrs, minus )[i], reservoir_at<last>( dev_ptrs, minus )[i] );
+    if constexpr ( T::dense ) {
+        Type::complex d_wf = 0.0;
+        Type::complex d_rv = 0.0;
+        sum_dense_ks<T>( i, dev_ptrs, minus, d_wf, d_rv );
+        const Type::real w = theta * theta * ( 1.0 - theta ) * ( 1.0 - theta );
+        wf += w * dt * d_wf;
+        rv += w * dt * d_rv;
+    }
+    ( minus ? dev_ptrs.dense_wavefunction_minus : dev_ptrs.dense_wavefunction_plus )[i] = wf;
+    ( minus ? dev_ptrs.dense_reservoir_minus : dev_ptrs.dense_reservoir_plus )[i] = rv;
+}
+
+} // namespace PC3::Kernel::RK
+
+namespace PC3::Kernel::Compute {
+
+/**
+ * Fused RK stage S of the tableau T. Evaluates K_S from the input of stage S and processes it
+ * using RK::tableau_stage_sum. The last stage of an adaptive tableau additionally reduces the
+ * scaled squared local error into norm.partial_sums, see RK::reduce_partial_sums. The error norm
+ * is not used by the other stages.
+ */
+template <class T, int S>
+PULSE_GLOBAL void gp_scalar_tableau( int i, Type::real t, Type::complex dt, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p_in, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, RK::ErrorNorm norm ) {
+
+    LOCAL_SHARE_STRUCT( SystemParameters::KernelParameters, p_in, p );
+
+    if constexpr ( T::adaptive and S == T::stages - 1 ) {
+        OVERWRITE_THREAD_INDEX_NO_RETURN( i );
+        Type::real values[RK::n_reduced] = {};
+        if ( i < p.N2 )
+            values[RK::error_sum] = RK::gp_scalar_stage<T, S>( i, dt, dev_ptrs, p, oscillation_pulse, oscillation_pump, oscillation_potential, norm );
+        RK::reduce_partial_sums( i, p, norm.partial_sums, values );
+    } else {
+        OVERWRITE_THREAD_INDEX( i );
+        RK::gp_scalar_stage<T, S>( i, dt, dev_ptrs, p, oscillation_pulse, oscillation_pump, oscillation_potential, norm );
+    }
+}
+
+template <class T, int S>
+PULSE_GLOBAL void gp_tetm_tableau( int i, Type::real t, Type::complex dt, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p_in, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, RK::ErrorNorm norm ) {
+
+    LOCAL_SHARE_STRUCT( SystemParameters::KernelParameters, p_in, p );
+
+    if constexpr ( T::adaptive and S == T::stages - 1 ) {
+        OVERWRITE_THREAD_INDEX_NO_RETURN( i );
+        Type::real values[RK::n_reduced] = {};
+        if ( i < p.N2 )
+            values[RK::error_sum] = RK::gp_tetm_stage<T, S>( i, dt, dev_ptrs, p, oscillation_pulse, oscillation_pump, oscillation_potential, norm );
+        RK::reduce_partial_sums( i, p, norm.partial_sums, values );
+    } else {
+        OVERWRITE_THREAD_INDEX( i );
+        RK::gp_tetm_stage<T, S>( i, dt, dev_ptrs, p, oscillation_pulse, oscillation_pump, oscillation_potential, norm );
+    }
+}
+
+/**
+ * First stage of the FSAL tableau T using the stored K_0 instead of evaluating the right hand side.
+ * K_0 is either left over from a rejected attempt or carried over from the last stage of the previous step.
+ */
+template <class T>
+PULSE_GLOBAL void gp_tableau_cached_first_stage( int i, Type::complex dt, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p_in ) {
+    static_assert( T::fsal, "Only FSAL tableaus cache K_0" );
+
+    LOCAL_SHARE_STRUCT( SystemParameters::KernelParameters, p_in, p );
+
+    OVERWRITE_THREAD_INDEX( i );
+
+    // The multi-rate mode does not store the reservoir Ks
+    constexpr int slot = RK::Tableau::k_slot<T>( 0 );
+    const bool with_reservoir = not p.multi_rate;
+    RK::tableau_stage_sum<T, 0, false>( i, dt, dev_ptrs, RK::wavefunction_at<slot>( dev_ptrs, false )[i], with_reservoir ? RK::reservoir_at<slot>( dev_ptrs, false )[i] : Type::complex( 0.0 ), false, with_reservoir );
+    if ( p.use_twin_mode )
+        RK::tableau_stage_sum<T, 0, false>( i, dt, dev_ptrs, RK::wavefunction_at<slot>( dev_ptrs, true )[i], with_reservoir ? RK::reservoir_at<slot>( dev_ptrs, true )[i] : Type::complex( 0.0 ), true, with_reservoir );
+}
+
+/**
+ * Writes the dense output at t0 + theta * dt of the last step of the tableau T into the dense matrices.
+ * The Ks of the last step have to be located at RK::Tableau::dense_slot.
+ */
+template <class T>
+PULSE_GLOBAL void gp_tableau_dense_output( int i, Type::real theta, Type::complex dt, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p_in ) {
+
+    LOCAL_SHARE_STRUCT( SystemParameters::KernelParameters, p_in, p );
+
+    OVERWRITE_THREAD_INDEX( i );
+
+    RK::dense_output<T>( i, theta, dt, dev_ptrs, false );
+    if ( p.use_twin_mode )
+        RK::dense_output<T>( i, theta, dt, dev_ptrs, true );
+}
+
+} // namespace PC3::Kernel::Compute
@@ -0,0 +1,298 @@
+#pragma once
+#include <complex>
+#include "cuda/typedef.cuh"
+
+/*
+ * This file contains the Butcher tableaus of the Runge-Kutta iterators and the coefficients of the 2N-storage schemes.
+ * A tableau only consists of constants:
+ * stages:   Number of stages s
+ * fsal:     First Same As Last. The last row of a equals b, so the final result is the input of the last stage.
+ * adaptive: If true, the tableau provides the error weights e = b - b_hat of an embedded method of order embedded_order.
+ * dense:    If true, the tableau provides the weights d of a continuous extension, see dense_output in kernel_runge_kutta.cuh.
+ *           Otherwise, the dense output uses the cubic Hermite interpolation.
+ * c[s], a[s][s], b[s] and optionally e[s] and d[s].
+ * Everything else, in particular which Ks have to be stored and where the stage inputs live, is derived
+ * at compile time by the functions below. New schemes only require a new tableau struct and an iterator entry.
+ */
+namespace PC3::Kernel::RK::Tableau {
+
+// Kutta's third order method (Simpson's rule)
+struct RK3 {
+    static constexpr int stages = 3;
+    static constexpr bool fsal = false;
+    static constexpr bool adaptive = false;
+    static constexpr bool dense = false;
+    static constexpr double c[stages] = { 0.0, 1. / 2., 1.0 };
+    static constexpr double a[stages][stages] = {
+        {},
+        { 1. / 2. },
+        { -1.0, 2.0 },
+    };
+    static constexpr double b[stages] = { 1. / 6., 4. / 6., 1. / 6. };
+};
+
+// Classical fourth order Runge-Kutta method
+struct RK4 {
+    static constexpr int stages = 4;
+    static constexpr bool fsal = false;
+    static constexpr bool adaptive = false;
+    static constexpr bool dense = false;
+    static constexpr double c[stages] = { 0.0, 1. / 2., 1. / 2., 1.0 };
+    static constexpr double a[stages][stages] = {
+        {},
+        { 1. / 2. },
+        { 0.0, 1. / 2. },
+        { 0.0, 0.0, 1.0 },
+    };
+    static constexpr double b[stages] = { 1. / 6., 1. / 3., 1. / 3., 1. / 6. };
+};
+
+// Stochastic Heun method with two iterations of the trapezoidal corrector. The noise increment is drawn once per step
+// and enters every stage through the right hand side, so the noise amplitude is averaged between the current state and
+// the corrected state, which is consistent with the Stratonovich interpretation. The noise amplitude only depends on the
+// reservoir, so the Milstein correction vanishes. A single corrector iteration is unstable on the imaginary axis; two
+// iterations give R(z) = 1 + z + z^2/2 + z^3/4, which is stable for |Im z| <= 2. This is smaller than the interval of RK4,
+// so the kinetic term is propagated exactly in k-space, see Solver::iterateIntegratingFactorStochasticHeun.
+struct StochasticHeun {
+    static constexpr int stages = 3;
+    static constexpr bool fsal = false;
+    static constexpr bool adaptive = false;
+    static constexpr bool dense = false;
+    static constexpr double c[stages] = { 0.0, 1.0, 1.0 };
+    static constexpr double a[stages][stages] = {
+        {},
+        { 1.0 },
+        { 1. / 2., 1. / 2. },
+    };
+    static constexpr double b[stages] = { 1. / 2., 0.0, 1. / 2. };
+};
+
+// Bogacki-Shampine 3(2) method
+struct BS32 {
+    static constexpr int stages = 4;
+    static constexpr bool fsal = true;
+    static constexpr bool adaptive = true;
+    static constexpr bool dense = false;
+    static constexpr int embedded_order = 2;
+    static constexpr double c[stages] = { 0.0, 1. / 2., 3. / 4., 1.0 };
+    static constexpr double a[stages][stages] = {
+        {},
+        { 1. / 2. },
+        { 0.0, 3. / 4. },
+        { 2. / 9., 1. / 3., 4. / 9. },
+    };
+    static constexpr double b[stages] = { 2. / 9., 1. / 3., 4. / 9., 0.0 };
+    static constexpr double e[stages] = { 2. / 9. - 7. / 24., 1. / 3. - 1. / 4., 4. / 9. - 1. / 3., -1. / 8. };
+};
+
+// Dormand-Prince 5(4) method
+struct DP45 {
+    static constexpr int stages = 7;
+    static constexpr bool fsal = true;
+    static constexpr bool adaptive = true;
+    static constexpr bool dense = true;
+    static constexpr int embedded_order = 4;
+    static constexpr double c[stages] = { 0.0, 1. / 5., 3. / 10., 4. / 5., 8. / 9., 1.0, 1.0 };
+    static constexpr double a[stages][stages] = {
+        {},
+        { 1. / 5. },
+        { 3. / 40., 9. / 40. },
+        { 44. / 45., -56. / 15., 32. / 9. },
+        { 19372. / 6561., -25360. / 2187., 64448. / 6561., -212. / 729. },
+        { 9017. / 3168., -355. / 33., 46732. / 5247., 49. / 176., -5103. / 18656. },
+        { 35. / 384., 0.0, 500. / 1113., 125. / 192., -2187. / 6784., 11. / 84. },
+    };
+    static constexpr double b[stages] = { 35. / 384., 0.0, 500. / 1113., 125. / 192., -2187. / 6784., 11. / 84., 0.0 };
+    static constexpr double e[stages] = { 35. / 384. - 5179. / 57600., 0.0, 500. / 1113. - 7571. / 16695., 125. / 192. - 393. / 640., -2187. / 6784. + 92097. / 339200., 11. / 84. - 187. / 2100., -1. / 40. };
+    // Continuous extension of Shampine (Math. Comp. 46, 135 (1986)) in the form of Hairer, Norsett and Wanner
+    static constexpr double d[stages] = { -12715105075. / 11282082432., 0.0, 87487479700. / 32700410799., -10690763975. / 1880347072., 701980252875. / 199316789632., -1453857185. / 822651844., 69997945. / 29380423. };
+};
+
+// Tsitouras 5(4) method (Comput. Math. Appl. 62, 770 (2011))
+struct Tsit5 {
+    static constexpr int stages = 7;
+    static constexpr bool fsal = true;
+    static constexpr bool adaptive = true;
+    static constexpr bool dense = false;
+    static constexpr int embedded_order = 4;
+    static constexpr double c[stages] = { 0.0, 0.161, 0.327, 0.9, 0.9800255409045097, 1.0, 1.0 };
+    static constexpr double a[stages][stages] = {
+        {},
+        { 0.161 },
+        { -0.008480655492356989, 0.335480655492357 },
+        { 2.897153057105493, -6.359448489975075, 4.3622954328695815 },
+        { 5.325864828439257, -11.748883564062828, 7.4955393428898365, -0.09249506636175525 },
+        { 5.86145544294642, -12.92096931784711, 8.159367898576159, -0.071584973281401, -0.028269050394068383 },
+        { 0.09646076681806523, 0.01, 0.4798896504144996, 1.379008574103742, -3.290069515436081, 2.324710524099774 },
+    };
+    static constexpr double b[stages] = { 0.09646076681806523, 0.01, 0.4798896504144996, 1.379008574103742, -3.290069515436081, 2.324710524099774, 0.0 };
+    static constexpr double e[stages] = { 0.001780011052226, 0.000816434459657, -0.007880878010262, 0.144711007173263, -0.582357165452555, 0.458082105929187, -1. / 66. };
+};
+
+// Third order, three stage 2N-storage method by Williamson (J. Comput. Phys. 35, 48 (1980)) in Williamson form
+struct LowStorage3 {
+    static constexpr int stages = 3;
+    static constexpr double A[stages] = { 0.0, -5.0 / 9.0, -153.0 / 128.0 };
+    static constexpr double B[stages] = { 1.0 / 3.0, 15.0 / 16.0, 8.0 / 15.0 };
+    static constexpr double C[stages] = { 0.0, 1.0 / 3.0, 3.0 / 4.0 };
+};
+
+// Fourth order, five stage 2N-storage method by Carpenter and Kennedy (NASA TM-109112 (1994), solution 3) in Williamson form
+struct LowStorage4 {
+    static constexpr int stages = 5;
+    static constexpr double A[stages] = { 0.0, -567301805773.0 / 1357537059087.0, -2404267990393.0 / 2016746695238.0, -3550918686646.0 / 2091501179385.0, -1275806237668.0 / 842570457699.0 };
+    static constexpr double B[stages] = { 1432997174477.0 / 9575080441755.0, 5161836677717.0 / 13612068292357.0, 1720146321549.0 / 2090206949498.0, 3134564353537.0 / 4481467310338.0, 2277821191437.0 / 14882151754819.0 };
+    static constexpr double C[stages] = { 0.0, 1432997174477.0 / 9575080441755.0, 2526269341429.0 / 6820363962896.0, 2006345519317.0 / 3224310063776.0, 2802321613138.0 / 2924317926251.0 };
+};
+
+// Locations of the stage inputs. Non-negative locations are K matrix slots.
+constexpr int wavefunction = -1;
+constexpr int buffer = -2;
+// Row indices selecting the final weights b or the error weights e instead of a row of a
+constexpr int final_row = -1;
+constexpr int error_row = -2;
+constexpr int dense_row = -3;
+
+// Weight of K_n in the given row. Non-negative rows are the stage inputs. Only use in constant expressions.
+template <class T>
+PULSE_HOST_DEVICE constexpr double weight( const int row, const int n ) {
+    if ( row == final_row )
+        return T::b[n];
+    if constexpr ( T::adaptive ) {
+        if ( row == error_row )
+            return T::e[n];
+    }
+    if constexpr ( T::dense ) {
+        if ( row == dense_row )
+            return T::d[n];
+    }
+    return T::a[row][n];
+}
+
+// K_s is stored if any stage input except the directly following one or the error estimate requires it.
+// The directly following stage input is written by the stage itself, and the last K is never reread.
+// With FSAL, K_0 is always stored, because it is reused by rejected steps and carried over from the
+// last stage of the previous step. The last K is then stored in the separate slot fsal_slot.
+template <class T>
+PULSE_HOST_DEVICE constexpr bool is_stored( const int s ) {
+    if ( s >= T::stages - 1 )
+        return false;
+    if constexpr ( T::fsal )
+        if ( s == 0 )
+            return true;
+    for ( int j = s + 2; j < T::stages; j++ )
+        if ( T::a[j][s] != 0.0 )
+            return true;
+    if constexpr ( T::adaptive )
+        return T::e[s] != 0.0;
+    return false;
+}
+
+// K matrix slot of a stored K_s. The stored Ks are packed into the first K matrices.
+template <class T>
+PULSE_HOST_DEVICE constexpr int k_slot( const int s ) {
+    int slot = 0;
+    for ( int n = 0; n < s; n++ )
+        slot += is_stored<T>( n ) ? 1 : 0;
+    return slot;
+}
+
+// Location of the input of stage j. The inputs alternate between two locations behind the stored Ks.
+// Without FSAL, the buffer accumulates the final sum, so two K matrices are used. With FSAL, the last
+// stage input is the final result, which is written to the buffer, and the buffer is the second location.
+template <class T>
+PULSE_HOST_DEVICE constexpr int input_location( const int j ) {
+    if ( j == 0 )
+        return wavefunction;
+    const int slot = k_slot<T>( T::stages - 1 );
+    if constexpr ( T::fsal )
+        return ( T::stages - 1 - j ) % 2 == 0 ? buffer : slot;
+    return slot + j % 2;
+}
+
+// Number of K matrices used by the stored Ks and the stage inputs
+template <class T>
+PULSE_HOST_DEVICE constexpr int k_inputs() {
+    int k = 0;
+    for ( int j = 1; j < T::stages; j++ )
+        k = input_location<T>( j ) + 1 > k ? input_location<T>( j ) + 1 : k;
+    return k;
+}
+
+// K matrix slot of the last K of an FSAL tableau. After an accepted step, it is swapped with the slot
+// of K_0, because the last K of this step is the first K of the next step.
+template <class T>
+PULSE_HOST_DEVICE constexpr int fsal_slot() {
+    return k_inputs<T>();
+}
+
+// Number of K matrices required by the tableau
+template <class T>
+PULSE_HOST_DEVICE constexpr int k_max() {
+    if constexpr ( T::fsal )
+        return fsal_slot<T>() + 1;
+    return k_inputs<T>();
+}
+
+// K matrix slot of K_s after an accepted step, which is used by the dense output. For FSAL tableaus,
+// the first and the last K have been swapped. The right hand sides of the current and the previous
+// state of non FSAL tableaus are evaluated separately for the dense output and stored in the first two slots.
+template <class T>
+PULSE_HOST_DEVICE constexpr int dense_slot( const int s ) {
+    if constexpr ( T::fsal ) {
+        if ( s == 0 )
+            return fsal_slot<T>();
+        if ( s == T::stages - 1 )
+            return k_slot<T>( 0 );
+        return k_slot<T>( s );
+    }
+    return s == 0 ? 0 : 1;
+}
+
+// FSAL tableaus have to have b equal to the last row of a. A continuous extension requires the Ks of
+// the last step, which are only kept by FSAL tableaus. The Hermite interpolation requires two K matrices.
+template <class T>
+constexpr bool is_consistent() {
+    if constexpr ( T::fsal ) {
+        for ( int n = 0; n < T::stages - 1; n++ )
+            if ( T::a[T::stages - 1][n] != T::b[n] )
+                return false;
+        if ( T::b[T::stages - 1] != 0.0 )
+            return false;
+    }
+    if constexpr ( T::dense ) {
+        for ( int n = 1; n < T::stages - 1; n++ )
+            if ( T::d[n] != 0.0 and not is_stored<T>( n ) )
+                return false;
+        return T::fsal;
+    }
+    return k_max<T>() >= 2;
+}
+
+// Stability function R(z) = 1 + z b^T (1 - z a)^-1 1 of the tableau T. A step of the test equation y' = lambda y multiplies y by R(lambda dt).
+template <class T>
+std::complex<double> stability_function( const std::complex<double> z ) {
+    std::complex<double> stage[T::stages];
+    std::complex<double> result = 1.0;
+    for ( int s = 0; s < T::stages; s++ ) {
+        stage[s] = 1.0;
+        for ( int n = 0; n < s; n++ )
+            stage[s] += z * T::a[s][n] * stage[n];
+        result += z * T::b[s] * stage[s];
+    }
+    return result;
+}
+
+// Stability function of the 2N-storage scheme T, evaluated by applying a single step to the test equation
+template <class T>
+std::complex<double> low_storage_stability_function( const std::complex<double> z ) {
+    std::complex<double> y = 1.0;
+    std::complex<double> du = 0.0;
+    for ( int s = 0; s < T::stages; s++ ) {
+        du = T::A[s] * du + z * y;
+        y += T::B[s] * du;
+    }
+    return y;
+}
+
+} // namespace PC3::Kernel::RK::Tableau
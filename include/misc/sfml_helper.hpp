@@ -44,6 +44,8 @@ BasicWindow& getWindow() {
 }
 
 std::unique_ptr<Type::real[]> __plotarray;
+// The FFT is kept unshifted; this holds the shifted FFT (plus and minus) for plotting
+std::unique_ptr<Type::complex[]> __fftplotarray;
 template <typename T>
 void plotMatrix( T* buffer, int NX, int NY, int posX, int posY, int skip, ColorPalette& cp, const std::string& title = "", bool plot_min_max = true ) {
     if ( buffer == nullptr )
@@ -109,6 +111,7 @@ void initSFMLWindow( PC3::Solver& solver ) {
     __local_colorpalette_phase.initColors();
     getWindow().init();
     __plotarray = std::make_unique<Type::real[]>( solver.system.p.N_x * solver.system.p.N_y );
+    __fftplotarray = std::make_unique<Type::complex[]>( 2 * solver.system.p.N_x * solver.system.p.N_y );
 
     cb_toggle_fft = CheckBox( 10, 50, "Toggle FFT Plot", false );
     getWindow().addObject( &cb_toggle_fft );
@@ -144,17 +147,34 @@ bool plotSFMLWindow( PC3::Solver& solver, double simulation_time, double elapsed
 
     Type::complex *inset_plot_array_plus = nullptr, *inset_plot_array_minus = nullptr;
     if ( __local_inset == 1 ) {
+        // Without an FFT mask or with -ssfmMask, the FFT is only calculated on demand
+        if ( current_subplot == 0 and ( solver.system.fft_mask.size() == 0 or solver.system.fft_mask_in_ssfm ) and solver.system.fft_every < solver.system.t_max )
+            solver.calculateVisualizationFFT();
         std::vector<PC3::CUDAMatrix<Type::complex>*> subplots{ &solver.matrix.fft_plus,
                                                                 &solver.matrix.k1_wavefunction_plus, &solver.matrix.k2_wavefunction_plus, &solver.matrix.k3_wavefunction_plus, &solver.matrix.k4_wavefunction_plus,
                                                                 &solver.matrix.k1_reservoir_plus, &solver.matrix.k2_reservoir_plus, &solver.matrix.k3_reservoir_plus, &solver.matrix.k4_reservoir_plus,
                                                                 &solver.matrix.pump_plus, &solver.matrix.pulse_plus, &solver.matrix.potential_plus, &solver.matrix.random_number };
         inset_plot_array_plus = subplots[current_subplot]->deviceToHostSync().getHostPtr();
         if ( solver.system.p.use_twin_mode ) {
-            std::vector<PC3::CUDAMatrix<Type::complex>*> subplots{ &solver.matrix.fft_minus,
-                                                                    &solver.matrix.k1_wavefunction_minus, &solver.matrix.k2_wavefunction_minus, &solver.matrix.k3_wavefunction_minus, &solver.matrix.k4_wavefunction_minus,
+            // The FFT and the wavefunction k matrices are stacked; their minus component is the second half of the plus matrix.
+            std::vector<PC3::CUDAMatrix<Type::complex>*> subplots{ nullptr, nullptr, nullptr, nullptr, nullptr,
                                                                     &solver.matrix.k1_reservoir_minus, &solver.matrix.k2_reservoir_minus, &solver.matrix.k3_reservoir_minus, &solver.matrix.k4_reservoir_minus,
                                                                     &solver.matrix.pump_minus, &solver.matrix.pulse_minus, &solver.matrix.potential_minus, &solver.matrix.random_number };
-            inset_plot_array_minus = subplots[current_subplot]->deviceToHostSync().getHostPtr();
+            if ( subplots[current_subplot] == nullptr )
+                inset_plot_array_minus = inset_plot_array_plus + solver.system.p.N2;
+            else
+                inset_plot_array_minus = subplots[current_subplot]->deviceToHostSync().getHostPtr();
+        }
+        // Shift k = 0 to the center of the FFT plot
+        if ( current_subplot == 0 and inset_plot_array_plus != nullptr ) {
+            for ( int c = 0; c < ( solver.system.p.use_twin_mode ? 2 : 1 ); c++ ) {
+                Type::complex* fft = inset_plot_array_plus + c * solver.system.p.N2;
+                for ( int i = 0; i < solver.system.p.N2; i++ )
+                    __fftplotarray[c * solver.system.p.N2 + i] = fft[PC3::Kernel::fft_shift_index( i, solver.system.p.N_x, solver.system.p.N_y )];
+            }
+            inset_plot_array_plus = __fftplotarray.get();
+            if ( solver.system.p.use_twin_mode )
+                inset_plot_array_minus = __fftplotarray.get() + solver.system.p.N2;
         }
     }
     if ( getWindow().keyPressed( BasicWindow::KEY_i ) ) {
@@ -2,11 +2,16 @@
 
 #include <iostream>
 #include <map>
+#include <vector>
 #include <functional>
+#ifdef USE_CPU
+    #include <future>
+#endif
 #include "cuda/typedef.cuh"
 #include "cuda/cuda_matrix.cuh"
 #include "cuda/cuda_macro.cuh"
 #include "kernel/kernel_fft.cuh"
+#include "kernel/kernel_runge_kutta_tableau.cuh"
 #include "system/system_parameters.hpp"
 #include "system/filehandler.hpp"
 #include "solver/matrix_container.hpp"
@@ -56,8 +61,15 @@ class Solver {
     Solver( PC3::SystemParameters& system ) : system( system ), filehandler( system.filehandler ) {
         std::cout << PC3::CLIO::prettyPrint( "Creating Solver...", PC3::CLIO::Control::Info ) << std::endl;
 
+        // Import FFT wisdom before any FFT plan is created
+        importFFTWisdom();
+
         // Initialize all host matrices
         initializeHostMatricesFromSystem();
+        // Replace the magic timestep by the stability limit of the iterator, which depends on the initial matrices.
+        // The stochastic Heun iterator is always checked, because an unstable timestep is hidden by the noise until it diverges.
+        if ( system.auto_dt or system.iterator == "sheun" )
+            estimateStableTimestep();
         // Then output all matrices to file. If --output was not passed in argv, this method outputs everything.
         outputInitialMatrices();
         // Copy remaining stuff to Device.
@@ -67,6 +79,7 @@ class Solver {
     
     void initializeHostMatricesFromSystem();               // Evaluates the envelopes and initializes the host matrices
     void initializeDeviceMatricesFromHost();               // Transfers the host matrices to their device equivalents
+    void estimateStableTimestep();                         // Estimates the largest stable timestep of the iterator from the host matrices
 
     // Output (Final) Host Matrices to files
     void outputMatrices( const unsigned int start_x, const unsigned int end_x, const unsigned int start_y, const unsigned int end_y, const unsigned int increment, const std::string& suffix = "", const std::string& prefix = "" );
@@ -81,31 +94,158 @@ class Solver {
     void iterateFixedTimestepRungeKutta3( dim3 block_size, dim3 grid_size );
     void iterateFixedTimestepRungeKutta4( dim3 block_size, dim3 grid_size );
     void iterateVariableTimestepRungeKutta( dim3 block_size, dim3 grid_size );
+    void iterateVariableTimestepRungeKutta23( dim3 block_size, dim3 grid_size );
+    void iterateVariableTimestepTsitouras5( dim3 block_size, dim3 grid_size );
+    // Runge-Kutta iterators generated from the Butcher tableau T. See kernel/kernel_runge_kutta_tableau.cuh
+    template <class T>
+    void iterateFixedTimestepTableau( dim3 block_size, dim3 grid_size );
+    template <class T>
+    void iterateVariableTimestepTableau( dim3 block_size, dim3 grid_size );
+    // Cache blocked wavefront sweep over n_steps timesteps of the tableau T on the CPU
+    template <class T>
+    void iterateWavefrontTableau( SystemParameters::KernelParameters& p, Type::complex dt, const int n_steps );
+    // Number of timesteps the next wavefront sweep can advance without passing next_output_time or changing the envelopes
+    int wavefrontSteps();
+    // Height of the row bands of the wavefront sweep
+    int wavefrontRows();
+    // Number of timesteps advanced by the last iteration
+    int fused_steps = 1;
+    // Time of the next output, set by the main loop. Fused timesteps never pass it.
+    Type::real next_output_time = 0.0;
+    // Launches the fused stage kernels S ... T::stages - 1 of the tableau T
+    template <class T, int S = 0>
+    void calculateTableauStages( dim3 block_size, dim3 grid_size, SystemParameters::KernelParameters& p, Type::complex dt );
+    // Dense output of the Runge-Kutta iterators at the time t within the last step
+    void denseOutputRungeKutta3( dim3 block_size, dim3 grid_size, Type::real t );
+    void denseOutputRungeKutta4( dim3 block_size, dim3 grid_size, Type::real t );
+    void denseOutputRungeKutta45( dim3 block_size, dim3 grid_size, Type::real t );
+    void denseOutputRungeKutta23( dim3 block_size, dim3 grid_size, Type::real t );
+    void denseOutputTsitouras5( dim3 block_size, dim3 grid_size, Type::real t );
+    template <class T>
+    void denseOutputTableau( dim3 block_size, dim3 grid_size, Type::real t );
     void iterateSplitStepFourier( dim3 block_size, dim3 grid_size );
+    void iterateSplitStepFourier4( dim3 block_size, dim3 grid_size );
+    void iterateSplitStepFourier6( dim3 block_size, dim3 grid_size );
+    // Composition of Strang steps with the fractional timesteps weights[i]*dt
+    void iterateSplitStepComposition( dim3 block_size, dim3 grid_size, const std::vector<Type::real>& weights );
+    void iterateVariableTimestepSplitStepFourier( dim3 block_size, dim3 grid_size );
+    void iterateIntegratingFactorRungeKutta4( dim3 block_size, dim3 grid_size );
+    void iterateIntegratingFactorStochasticHeun( dim3 block_size, dim3 grid_size );
+    void iterateAlternatingDirectionImplicit( dim3 block_size, dim3 grid_size );
+    void iterateLowStorageRungeKutta3( dim3 block_size, dim3 grid_size );
+    void iterateLowStorageRungeKutta4( dim3 block_size, dim3 grid_size );
+    // 2N-storage Runge-Kutta scheme with the Williamson coefficients A, B and the stage times C
+    void iterateLowStorageRungeKutta( dim3 block_size, dim3 grid_size, const std::vector<Type::real>& A, const std::vector<Type::real>& B, const std::vector<Type::real>& C );
+    // Timestep proposed by an adaptive iterator for the next iteration. Zero for fixed timestep iterators.
+    Type::real proposed_dt = 0.0;
+    // Set when the K_0 slot of an FSAL tableau holds the right hand side of the current state. Reset whenever the state or the right hand side changes outside of the iterator.
+    bool rk_first_stage_cached = false;
+    // Partial sums of the squared error and norm of the adaptive tableau iterators, see Kernel::RK::reduce_partial_sums
+    PC3::CUDAMatrix<Type::real> rk_partial_sums;
+    // True if the state at the output times is interpolated within the last step instead of shortening the timestep
+    bool useDenseOutput();
+    // Start time and timestep of the last step, set by the iterators providing a dense output
+    Type::real dense_output_t0 = 0.0;
+    Type::real dense_output_dt = 0.0;
+    // Set when the right hand sides of both states of the last step are evaluated for the Hermite interpolation of non FSAL tableaus
+    bool dense_output_slopes_evaluated = false;
+    // Replaces the state by the dense output at the time t until endDenseOutput is called. Does nothing if t is not within the last step.
+    void beginDenseOutput( Type::real t );
+    void endDenseOutput();
+    // Time of the last step while the dense output replaces the state. Negative if the dense output is not active.
+    Type::real dense_output_t1 = -1.0;
+    void swapDenseOutput();
+    // Rebuilds the cached linear k-space propagators for the linear sub-steps dts[i] if any of them changed
+    void updateFFTPropagator( dim3 block_size, dim3 grid_size, const std::vector<Type::complex>& dts );
+    std::vector<Type::complex> fft_propagator_dt;
+    // Device pointer to the cached propagator with the given index
+    Type::complex* getFFTPropagator( int index );
+    // Set when the trailing linear half step of the SSFM is deferred and can be fused with the next leading half step
+    bool ssfm_half_step_pending = false;
+    // Applies a deferred linear SSFM half step before the wavefunction is evaluated outside of the iteration
+    void flushPendingHalfStep();
+    // Precomputes the tridiagonal line coefficients of the ADI iterator for the linear sub-step tau. Only recalculated when tau changes.
+    void updateADICoefficients( Type::complex tau );
+    Type::complex adi_tau = 0.0;
+    // Line coefficients for the implicit x and y sweeps, stacked behind each other
+    PC3::CUDAMatrix<Type::complex> adi_coefficients;
     void normalizeImaginaryTimePropagation( dim3 block_size, dim3 grid_size );
+    // Fills buffer with the noise of the given iteration
+    void generateNoise( Type::complex* buffer, unsigned int iteration );
+    // Starts generating the noise of the given iteration into matrix.random_number_next in the background
+    void prefetchNoise( unsigned int iteration );
+    // Waits until the background noise generation has finished
+    void awaitNoise();
+    // Iteration whose noise is generated into matrix.random_number_next. Negative if nothing was prefetched.
+    long long noise_prefetched_iteration = -1;
+#ifdef USE_CPU
+    std::future<void> noise_future;
+#else
+    cudaStream_t noise_stream = nullptr;
+    // Recorded on the default stream before the prefetch and on the noise stream after it
+    cudaEvent_t noise_buffer_free, noise_ready;
+#endif
 
     struct iteratorFunction {
         int k_max;
         std::function<void( dim3, dim3 )> iterate;
+        // Number of cached linear k-space propagators for split step iterators
+        int n_fft_propagators = 0;
+        // Dense output at a time within the last step. Only provided by the Runge-Kutta tableau iterators.
+        std::function<void( dim3, dim3, Type::real )> dense_output = nullptr;
+        // Supports the multi-rate reservoir update, see Kernel::RK::multi_rate_reservoir
+        bool multi_rate = false;
+        // Supports the wavefront sweep, see Solver::iterateWavefrontTableau
+        bool wavefront = false;
+        // Supports the halo padded matrices, see Solver::fillHalo
+        bool halo_padding = false;
     };
     std::map<std::string, iteratorFunction> iterator = {
-        { "rk3", { 3, std::bind( &Solver::iterateFixedTimestepRungeKutta3, this, std::placeholders::_1, std::placeholders::_2 ) } },
-        { "rk4", { 4, std::bind( &Solver::iterateFixedTimestepRungeKutta4, this, std::placeholders::_1, std::placeholders::_2 ) } },
-        { "rk45", { 6, std::bind( &Solver::iterateVariableTimestepRungeKutta, this, std::placeholders::_1, std::placeholders::_2 ) } },
-        { "ssfm", { 2, std::bind( &Solver::iterateSplitStepFourier, this, std::placeholders::_1, std::placeholders::_2 ) } }
+        { "rk3", { Kernel::RK::Tableau::k_max<Kernel::RK::Tableau::RK3>(), std::bind( &Solver::iterateFixedTimestepRungeKutta3, this, std::placeholders::_1, std::placeholders::_2 ), 0, std::bind( &Solver::denseOutputRungeKutta3, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3 ), true, true, true } },
+        { "rk4", { Kernel::RK::Tableau::k_max<Kernel::RK::Tableau::RK4>(), std::bind( &Solver::iterateFixedTimestepRungeKutta4, this, std::placeholders::_1, std::placeholders::_2 ), 0, std::bind( &Solver::denseOutputRungeKutta4, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3 ), true, true, true } },
+        { "rk45", { Kernel::RK::Tableau::k_max<Kernel::RK::Tableau::DP45>(), std::bind( &Solver::iterateVariableTimestepRungeKutta, this, std::placeholders::_1, std::placeholders::_2 ), 0, std::bind( &Solver::denseOutputRungeKutta45, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3 ), true, false, true } },
+        { "rk23", { Kernel::RK::Tableau::k_max<Kernel::RK::Tableau::BS32>(), std::bind( &Solver::iterateVariableTimestepRungeKutta23, this, std::placeholders::_1, std::placeholders::_2 ), 0, std::bind( &Solver::denseOutputRungeKutta23, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3 ), true, false, true } },
+        { "tsit5", { Kernel::RK::Tableau::k_max<Kernel::RK::Tableau::Tsit5>(), std::bind( &Solver::iterateVariableTimestepTsitouras5, this, std::placeholders::_1, std::placeholders::_2 ), 0, std::bind( &Solver::denseOutputTsitouras5, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3 ), true, false, true } },
+                { "ssfm", { 2, std::bind( &Solver::iterateSplitStepFourier, this, std::placeholders::_1, std::placeholders::_2 ), 2 } },
+        { "ssfm4", { 2, std::bind( &Solver::iterateSplitStepFourier4, this, std::placeholders::_1, std::placeholders::_2 ), 4 } },
+        { "ssfm6", { 2, std::bind( &Solver::iterateSplitStepFourier6, this, std::placeholders::_1, std::placeholders::_2 ), 8 } },
+        { "assfm", { 3, std::bind( &Solver::iterateVariableTimestepSplitStepFourier, this, std::placeholders::_1, std::placeholders::_2 ), 2 } },
+        { "ifrk4", { 4, std::bind( &Solver::iterateIntegratingFactorRungeKutta4, this, std::placeholders::_1, std::placeholders::_2 ), 1 } },
+        { "sheun", { Kernel::RK::Tableau::k_max<Kernel::RK::Tableau::StochasticHeun>(), std::bind( &Solver::iterateIntegratingFactorStochasticHeun, this, std::placeholders::_1, std::placeholders::_2 ), 1 } },
+        { "adi", { 2, std::bind( &Solver::iterateAlternatingDirectionImplicit, this, std::placeholders::_1, std::placeholders::_2 ) } },
+        { "lsrk3", { 1, std::bind( &Solver::iterateLowStorageRungeKutta3, this, std::placeholders::_1, std::placeholders::_2 ) } },
+        { "lsrk4", { 1, std::bind( &Solver::iterateLowStorageRungeKutta4, this, std::placeholders::_1, std::placeholders::_2 ) } }
     };
 
     bool iterate();
 
-    void applyFFTFilter( dim3 block_size, dim3 grid_size, bool apply_mask = true );
+    void applyFFTFilter( dim3 block_size, dim3 grid_size );
+    // Set when the FFT Filter is due but deferred into the next linear SSFM half step (-ssfmMask)
+    bool fft_mask_pending = false;
+    // Set in TE/TM mode when the FFT masks of the two polarizations differ. The mask then does not commute with the linear propagator.
+    bool fft_mask_polarized = false;
+    // Applies a deferred FFT Filter before the wavefunction is evaluated outside of the iteration
+    void flushPendingFFTFilter();
+    // Calculates the (unshifted) FFT for output and plotting when no FFT mask is applied
+    void calculateVisualizationFFT();
 
     enum class FFT {
         inverse,
         forward
     };
     void calculateFFT( Type::complex* device_ptr_in, Type::complex* device_ptr_out, FFT dir );
+    void calculateFFT( Type::complex* device_ptr_in, Type::complex* device_ptr_out, FFT dir, int batch );
+    // Transforms both components of a stacked matrix
+    void calculateBatchedFFT( Type::complex* device_ptr_in, Type::complex* device_ptr_out, FFT dir );
+    // Import and export FFT planner wisdom. Only used by the CPU version.
+    void importFFTWisdom();
+    void exportFFTWisdom();
 
     void swapBuffers();
+    // Swaps the K matrices of the K matrix slots first and second. This only swaps the pointers, not the data.
+    void swapKMatrices( int first, int second );
+    // Fills the periodic halo of the padded stage inputs plus and minus, see Kernel::fill_halo. Only required with -haloPadding and periodic boundaries in y.
+    void fillHalo( Type::complex* plus, Type::complex* minus );
 
     void cacheValues();
     void cacheMatrices();
@@ -113,8 +253,12 @@ class Solver {
 
 // Helper macro to choose the correct runge function
 #define RUNGE_FUNCTION_GP (p.use_twin_mode ? PC3::Kernel::Compute::gp_tetm : PC3::Kernel::Compute::gp_scalar)
+#define RUNGE_FUNCTION_GP_TABLEAU( tableau, stage ) (p.use_twin_mode ? PC3::Kernel::Compute::gp_tetm_tableau<tableau, stage> : PC3::Kernel::Compute::gp_scalar_tableau<tableau, stage>)
+#define RUNGE_FUNCTION_GP_LOW_STORAGE (p.use_twin_mode ? PC3::Kernel::Compute::gp_tetm_low_storage : PC3::Kernel::Compute::gp_scalar_low_storage)
+#define RUNGE_FUNCTION_GP_PROPAGATOR (p.use_twin_mode ? PC3::Kernel::Compute::gp_tetm_linear_propagator : PC3::Kernel::Compute::gp_scalar_linear_propagator)
 #define RUNGE_FUNCTION_GP_LINEAR (p.use_twin_mode ? PC3::Kernel::Compute::gp_tetm_linear_fourier : PC3::Kernel::Compute::gp_scalar_linear_fourier)
 #define RUNGE_FUNCTION_GP_NONLINEAR (p.use_twin_mode ? PC3::Kernel::Compute::gp_tetm_nonlinear : PC3::Kernel::Compute::gp_scalar_nonlinear)
+#define RUNGE_FUNCTION_GP_NONLINEAR_MIDPOINT (p.use_twin_mode ? PC3::Kernel::Compute::gp_tetm_nonlinear_midpoint : PC3::Kernel::Compute::gp_scalar_nonlinear_midpoint)
 #define RUNGE_FUNCTION_GP_INDEPENDENT (p.use_twin_mode ? PC3::Kernel::Compute::gp_tetm_independent : PC3::Kernel::Compute::gp_scalar_independent)
 
 // Helper Macro to iterate a specific RK K
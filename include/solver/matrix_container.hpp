@@ -7,20 +7,46 @@ namespace PC3 {
 /**
 * DEFINE_MATRIX(type, name, size_scaling, index_for_initialization)
 * type: The type of the matrix (Type::real, Type::complex, etc.)
-* in_ptr_struct: If true, this matrix will be included in the pointer struct and can be accessed from the kernels: TODO
+* in_ptr_struct: If true, this matrix will be included in the pointer struct and can be accessed from the kernels.
+*                If false, the matrix is a host-only matrix and its device matrix is never constructed.
 * name: The name of the matrix
 * size_scaling: The scaling factor for the size of the matrix
 * condition_for_construction: if false, neither the host nor the device matrices are constructed
 * 
 * We use this not-so-pretty macro to define matrices to shorten this file and to 
 * make it easier for the user to add new matrices.
+*
+* Matrices that are transformed into Fourier space use a stacked layout: The plus matrix
+* is constructed with twin_stack = 2 (TE/TM) or 1 (scalar) grids and the minus component
+* is located directly behind the plus component. This way, both components can be
+* transformed using a single batched FFT. The minus matrices of these stacked matrices
+* are never constructed; their device pointers point into the plus matrix instead.
+* Stacked matrices are listed additionally in STACKED_MATRIX_LIST.
+*
+* The fft_propagator holds the cached linear k-space propagators of the split step
+* iterators, one for each linear sub-step length. In the scalar mode, a propagator is
+* a single grid. In TE/TM mode, the three grids hold the diagonal, the plus-minus and
+* the minus-plus elements of the 2x2 propagator. n_fft_propagators propagators are
+* stacked behind each other.
+*
+* The dense matrices hold the state interpolated to an output time within the last step
+* of the Runge-Kutta iterators. They are only constructed if the dense output is used.
+*
+* In the multi-rate mode, the reservoir is not integrated by the Runge-Kutta stages, so the
+* reservoir K matrices are not constructed.
+*
+* With a halo, every device matrix is padded by halo elements in front of and behind its data,
+* see CUDAMatrix. The stencils can then read the rows above and below the grid without bounds
+* checks, see kernel/kernel_hamilton.cuh. The K wavefunctions are stage inputs of the Runge-Kutta
+* iterators and need their own halo, so they are not stacked (k_stack = 1) and their minus matrices
+* are constructed separately.
 */
 
 #define MATRIX_LIST \
-    DEFINE_MATRIX(Type::complex, false, initial_state_plus, 1, false) \
-    DEFINE_MATRIX(Type::complex, false, initial_state_minus, 1, false) \
-    DEFINE_MATRIX(Type::complex, false, initial_reservoir_plus, 1, false) \
-    DEFINE_MATRIX(Type::complex, false, initial_reservoir_minus, 1, false) \
+    DEFINE_MATRIX(Type::complex, false, initial_state_plus, 1, true) \
+    DEFINE_MATRIX(Type::complex, false, initial_state_minus, 1, use_twin_mode) \
+    DEFINE_MATRIX(Type::complex, false, initial_reservoir_plus, 1, true) \
+    DEFINE_MATRIX(Type::complex, false, initial_reservoir_minus, 1, use_twin_mode) \
     DEFINE_MATRIX(Type::complex, true, wavefunction_plus, 1, true) \
     DEFINE_MATRIX(Type::complex, true, wavefunction_minus, 1, use_twin_mode) \
     DEFINE_MATRIX(Type::complex, true, reservoir_plus, 1, true) \
@@ -35,57 +61,61 @@ namespace PC3 {
     DEFINE_MATRIX(Type::complex, true, buffer_wavefunction_minus, 1, use_twin_mode) \
     DEFINE_MATRIX(Type::complex, true, buffer_reservoir_plus, 1, true) \
     DEFINE_MATRIX(Type::complex, true, buffer_reservoir_minus, 1, use_twin_mode) \
-    DEFINE_MATRIX(Type::real, true, fft_mask_plus, 1, use_fft) \
-    DEFINE_MATRIX(Type::real, true, fft_mask_minus, 1, use_fft and use_twin_mode) \
-    DEFINE_MATRIX(Type::complex, true, fft_plus, 1, use_fft) \
-    DEFINE_MATRIX(Type::complex, true, fft_minus, 1, use_fft and use_twin_mode) \
-    DEFINE_MATRIX(Type::complex, true, k1_wavefunction_plus, 1, k_max >= 1) \
-    DEFINE_MATRIX(Type::complex, true, k1_wavefunction_minus, 1, k_max >= 1 and use_twin_mode) \
-    DEFINE_MATRIX(Type::complex, true, k1_reservoir_plus, 1, k_max >= 1) \
-    DEFINE_MATRIX(Type::complex, true, k1_reservoir_minus, 1, k_max >= 1 and use_twin_mode) \
-    DEFINE_MATRIX(Type::complex, true, k2_wavefunction_plus, 1, k_max >= 2) \
-    DEFINE_MATRIX(Type::complex, true, k2_wavefunction_minus, 1, k_max >= 2 and use_twin_mode) \
-    DEFINE_MATRIX(Type::complex, true, k2_reservoir_plus, 1, k_max >= 2) \
-    DEFINE_MATRIX(Type::complex, true, k2_reservoir_minus, 1, k_max >= 2 and use_twin_mode) \
-    DEFINE_MATRIX(Type::complex, true, k3_wavefunction_plus, 1, k_max >= 3) \
-    DEFINE_MATRIX(Type::complex, true, k3_wavefunction_minus, 1, k_max >= 3 and use_twin_mode) \
-    DEFINE_MATRIX(Type::complex, true, k3_reservoir_plus, 1, k_max >= 3) \
-    DEFINE_MATRIX(Type::complex, true, k3_reservoir_minus, 1, k_max >= 3 and use_twin_mode) \
-    DEFINE_MATRIX(Type::complex, true, k4_wavefunction_plus, 1, k_max >= 4) \
-    DEFINE_MATRIX(Type::complex, true, k4_wavefunction_minus, 1, k_max >= 4 and use_twin_mode) \
-    DEFINE_MATRIX(Type::complex, true, k4_reservoir_plus, 1, k_max >= 4) \
-    DEFINE_MATRIX(Type::complex, true, k4_reservoir_minus, 1, k_max >= 4 and use_twin_mode) \
-    DEFINE_MATRIX(Type::complex, true, k5_wavefunction_plus, 1, k_max >= 5) \
-    DEFINE_MATRIX(Type::complex, true, k5_wavefunction_minus, 1, k_max >= 5 and use_twin_mode) \
-    DEFINE_MATRIX(Type::complex, true, k5_reservoir_plus, 1, k_max >= 5) \
-    DEFINE_MATRIX(Type::complex, true, k5_reservoir_minus, 1, k_max >= 5 and use_twin_mode) \
-    DEFINE_MATRIX(Type::complex, true, k6_wavefunction_plus, 1, k_max >= 6) \
-    DEFINE_MATRIX(Type::complex, true, k6_wavefunction_minus, 1, k_max >= 6 and use_twin_mode) \
-    DEFINE_MATRIX(Type::complex, true, k6_reservoir_plus, 1, k_max >= 6) \
-    DEFINE_MATRIX(Type::complex, true, k6_reservoir_minus, 1, k_max >= 6 and use_twin_mode) \
-    DEFINE_MATRIX(Type::complex, true, k7_wavefunction_plus, 1, k_max >= 7) \
-    DEFINE_MATRIX(Type::complex, true, k7_wavefunction_minus, 1, k_max >= 7 and use_twin_mode) \
-    DEFINE_MATRIX(Type::complex, true, k7_reservoir_plus, 1, k_max >= 7) \
-    DEFINE_MATRIX(Type::complex, true, k7_reservoir_minus, 1, k_max >= 7 and use_twin_mode) \
-    DEFINE_MATRIX(Type::complex, true, k8_wavefunction_plus, 1, k_max >= 8) \
-    DEFINE_MATRIX(Type::complex, true, k8_wavefunction_minus, 1, k_max >= 8 and use_twin_mode) \
-    DEFINE_MATRIX(Type::complex, true, k8_reservoir_plus, 1, k_max >= 8) \
-    DEFINE_MATRIX(Type::complex, true, k8_reservoir_minus, 1, k_max >= 8 and use_twin_mode) \
-    DEFINE_MATRIX(Type::complex, true, k9_wavefunction_plus, 1, k_max >= 9) \
-    DEFINE_MATRIX(Type::complex, true, k9_wavefunction_minus, 1, k_max >= 9 and use_twin_mode) \
-    DEFINE_MATRIX(Type::complex, true, k9_reservoir_plus, 1, k_max >= 9) \
-    DEFINE_MATRIX(Type::complex, true, k9_reservoir_minus, 1, k_max >= 9 and use_twin_mode) \
-    DEFINE_MATRIX(Type::complex, true, k10_wavefunction_plus, 1, k_max >= 10) \
-    DEFINE_MATRIX(Type::complex, true, k10_wavefunction_minus, 1, k_max >= 10 and use_twin_mode) \
-    DEFINE_MATRIX(Type::complex, true, k10_reservoir_plus, 1, k_max >= 10) \
-    DEFINE_MATRIX(Type::complex, true, k10_reservoir_minus, 1, k_max >= 10 and use_twin_mode) \
-    DEFINE_MATRIX(Type::complex, true, rk_error, 1, k_max > 4) \
+    DEFINE_MATRIX(Type::complex, true, dense_wavefunction_plus, 1, use_dense_output) \
+    DEFINE_MATRIX(Type::complex, true, dense_wavefunction_minus, 1, use_dense_output and use_twin_mode) \
+    DEFINE_MATRIX(Type::complex, true, dense_reservoir_plus, 1, use_dense_output) \
+    DEFINE_MATRIX(Type::complex, true, dense_reservoir_minus, 1, use_dense_output and use_twin_mode) \
+    DEFINE_MATRIX(Type::real, true, fft_mask_plus, twin_stack, use_fft) \
+    DEFINE_MATRIX(Type::real, true, fft_mask_minus, 0, false) \
+    DEFINE_MATRIX(Type::complex, true, fft_plus, twin_stack, use_fft) \
+    DEFINE_MATRIX(Type::complex, true, fft_minus, 0, false) \
+    DEFINE_MATRIX(Type::complex, true, k1_wavefunction_plus, k_stack, k_max >= 1) \
+    DEFINE_MATRIX(Type::complex, true, k1_wavefunction_minus, twin_stack - k_stack, k_max >= 1 and twin_stack > k_stack) \
+    DEFINE_MATRIX(Type::complex, true, k1_reservoir_plus, 1, k_max >= 1 and not multi_rate) \
+    DEFINE_MATRIX(Type::complex, true, k1_reservoir_minus, 1, k_max >= 1 and not multi_rate and use_twin_mode) \
+    DEFINE_MATRIX(Type::complex, true, k2_wavefunction_plus, k_stack, k_max >= 2) \
+    DEFINE_MATRIX(Type::complex, true, k2_wavefunction_minus, twin_stack - k_stack, k_max >= 2 and twin_stack > k_stack) \
+    DEFINE_MATRIX(Type::complex, true, k2_reservoir_plus, 1, k_max >= 2 and not multi_rate) \
+    DEFINE_MATRIX(Type::complex, true, k2_reservoir_minus, 1, k_max >= 2 and not multi_rate and use_twin_mode) \
+    DEFINE_MATRIX(Type::complex, true, k3_wavefunction_plus, k_stack, k_max >= 3) \
+    DEFINE_MATRIX(Type::complex, true, k3_wavefunction_minus, twin_stack - k_stack, k_max >= 3 and twin_stack > k_stack) \
+    DEFINE_MATRIX(Type::complex, true, k3_reservoir_plus, 1, k_max >= 3 and not multi_rate) \
+    DEFINE_MATRIX(Type::complex, true, k3_reservoir_minus, 1, k_max >= 3 and not multi_rate and use_twin_mode) \
+    DEFINE_MATRIX(Type::complex, true, k4_wavefunction_plus, k_stack, k_max >= 4) \
+    DEFINE_MATRIX(Type::complex, true, k4_wavefunction_minus, twin_stack - k_stack, k_max >= 4 and twin_stack > k_stack) \
+    DEFINE_MATRIX(Type::complex, true, k4_reservoir_plus, 1, k_max >= 4 and not multi_rate) \
+    DEFINE_MATRIX(Type::complex, true, k4_reservoir_minus, 1, k_max >= 4 and not multi_rate and use_twin_mode) \
+    DEFINE_MATRIX(Type::complex, true, k5_wavefunction_plus, k_stack, k_max >= 5) \
+    DEFINE_MATRIX(Type::complex, true, k5_wavefunction_minus, twin_stack - k_stack, k_max >= 5 and twin_stack > k_stack) \
+    DEFINE_MATRIX(Type::complex, true, k5_reservoir_plus, 1, k_max >= 5 and not multi_rate) \
+    DEFINE_MATRIX(Type::complex, true, k5_reservoir_minus, 1, k_max >= 5 and not multi_rate and use_twin_mode) \
+    DEFINE_MATRIX(Type::complex, true, k6_wavefunction_plus, k_stack, k_max >= 6) \
+    DEFINE_MATRIX(Type::complex, true, k6_wavefunction_minus, twin_stack - k_stack, k_max >= 6 and twin_stack > k_stack) \
+    DEFINE_MATRIX(Type::complex, true, k6_reservoir_plus, 1, k_max >= 6 and not multi_rate) \
+    DEFINE_MATRIX(Type::complex, true, k6_reservoir_minus, 1, k_max >= 6 and not multi_rate and use_twin_mode) \
+    DEFINE_MATRIX(Type::complex, true, k7_wavefunction_plus, k_stack, k_max >= 7) \
+    DEFINE_MATRIX(Type::complex, true, k7_wavefunction_minus, twin_stack - k_stack, k_max >= 7 and twin_stack > k_stack) \
+    DEFINE_MATRIX(Type::complex, true, k7_reservoir_plus, 1, k_max >= 7 and not multi_rate) \
+    DEFINE_MATRIX(Type::complex, true, k7_reservoir_minus, 1, k_max >= 7 and not multi_rate and use_twin_mode) \
+    DEFINE_MATRIX(Type::complex, true, k8_wavefunction_plus, k_stack, k_max >= 8) \
+    DEFINE_MATRIX(Type::complex, true, k8_wavefunction_minus, twin_stack - k_stack, k_max >= 8 and twin_stack > k_stack) \
+    DEFINE_MATRIX(Type::complex, true, k8_reservoir_plus, 1, k_max >= 8 and not multi_rate) \
+    DEFINE_MATRIX(Type::complex, true, k8_reservoir_minus, 1, k_max >= 8 and not multi_rate and use_twin_mode) \
+    DEFINE_MATRIX(Type::complex, true, k9_wavefunction_plus, k_stack, k_max >= 9) \
+    DEFINE_MATRIX(Type::complex, true, k9_wavefunction_minus, twin_stack - k_stack, k_max >= 9 and twin_stack > k_stack) \
+    DEFINE_MATRIX(Type::complex, true, k9_reservoir_plus, 1, k_max >= 9 and not multi_rate) \
+    DEFINE_MATRIX(Type::complex, true, k9_reservoir_minus, 1, k_max >= 9 and not multi_rate and use_twin_mode) \
+    DEFINE_MATRIX(Type::complex, true, k10_wavefunction_plus, k_stack, k_max >= 10) \
+    DEFINE_MATRIX(Type::complex, true, k10_wavefunction_minus, twin_stack - k_stack, k_max >= 10 and twin_stack > k_stack) \
+    DEFINE_MATRIX(Type::complex, true, k10_reservoir_plus, 1, k_max >= 10 and not multi_rate) \
+    DEFINE_MATRIX(Type::complex, true, k10_reservoir_minus, 1, k_max >= 10 and not multi_rate and use_twin_mode) \
+    DEFINE_MATRIX(Type::complex, true, fft_propagator, (use_twin_mode ? 3 : 1) * n_fft_propagators, n_fft_propagators > 0) \
     DEFINE_MATRIX(Type::complex, true, random_number, 1, use_stochastic) \
-    DEFINE_MATRIX(Type::cuda_random_state, true, random_state, 1, use_stochastic) \
-    DEFINE_MATRIX(Type::complex, false, snapshot_wavefunction_plus, 1, false) \
-    DEFINE_MATRIX(Type::complex, false, snapshot_wavefunction_minus, 1, false) \
-    DEFINE_MATRIX(Type::complex, false, snapshot_reservoir_plus, 1, false) \
-    DEFINE_MATRIX(Type::complex, false, snapshot_reservoir_minus, 1, false) // \ // <-- Don't forget the backslash!
+    DEFINE_MATRIX(Type::complex, true, random_number_next, 1, use_stochastic) \
+    DEFINE_MATRIX(Type::complex, false, snapshot_wavefunction_plus, 1, true) \
+    DEFINE_MATRIX(Type::complex, false, snapshot_wavefunction_minus, 1, use_twin_mode) \
+    DEFINE_MATRIX(Type::complex, false, snapshot_reservoir_plus, 1, true) \
+    DEFINE_MATRIX(Type::complex, false, snapshot_reservoir_minus, 1, use_twin_mode) // \ // <-- Don't forget the backslash!
     /////////////////////////////
     // Add your matrices here. //
     // Make sure to end each   //
@@ -93,11 +123,34 @@ namespace PC3 {
     // a backslash!            //
     /////////////////////////////
 
+/**
+* DEFINE_STACKED_MATRIX(name_plus, name_minus)
+* Stacked matrices. The minus pointer is set to the second grid of the plus matrix.
+*/
+#define STACKED_MATRIX_LIST \
+    DEFINE_STACKED_MATRIX(fft_mask_plus, fft_mask_minus) \
+    DEFINE_STACKED_MATRIX(fft_plus, fft_minus) \
+    DEFINE_STACKED_MATRIX(k1_wavefunction_plus, k1_wavefunction_minus) \
+    DEFINE_STACKED_MATRIX(k2_wavefunction_plus, k2_wavefunction_minus) \
+    DEFINE_STACKED_MATRIX(k3_wavefunction_plus, k3_wavefunction_minus) \
+    DEFINE_STACKED_MATRIX(k4_wavefunction_plus, k4_wavefunction_minus) \
+    DEFINE_STACKED_MATRIX(k5_wavefunction_plus, k5_wavefunction_minus) \
+    DEFINE_STACKED_MATRIX(k6_wavefunction_plus, k6_wavefunction_minus) \
+    DEFINE_STACKED_MATRIX(k7_wavefunction_plus, k7_wavefunction_minus) \
+    DEFINE_STACKED_MATRIX(k8_wavefunction_plus, k8_wavefunction_minus) \
+    DEFINE_STACKED_MATRIX(k9_wavefunction_plus, k9_wavefunction_minus) \
+    DEFINE_STACKED_MATRIX(k10_wavefunction_plus, k10_wavefunction_minus)
+
 struct MatrixContainer {
 
     // Cache triggers
-    bool use_twin_mode, use_fft, use_stochastic;
-    int k_max;
+    bool use_twin_mode, use_fft, use_stochastic, use_dense_output, multi_rate;
+    int k_max, n_fft_propagators;
+    // Number of grids in stacked matrices and the size of a single grid
+    int twin_stack;
+    size_t N2;
+    // Padding elements in front of and behind each device matrix and the number of grids in the K wavefunctions
+    int halo, k_stack;
 
     // Declare all matrices using a macro
     #define DEFINE_MATRIX(type, ptrstruct, name, size_scaling, condition_for_construction) PC3::CUDAMatrix<type> name;
@@ -109,18 +162,25 @@ struct MatrixContainer {
 
     // TODO: if reservoir... system.evaluateReservoir() !
 
-    // Construction Chain. The Host Matrix is always constructed (who carese about RAM right?) and the device matrix is constructed if the condition is met.
-    void constructAll( const int N_x, const int N_y, bool use_twin_mode, bool use_fft, bool use_stochastic, int k_max, const int n_pulses, const int n_pumps, const int n_potentials ) {
+    // Construction Chain. If the condition is met, the host matrix is constructed and, unless the matrix is host-only, the device matrix as well.
+    void constructAll( const int N_x, const int N_y, bool use_twin_mode, bool use_fft, bool use_stochastic, bool use_dense_output, bool multi_rate, int halo, int n_fft_propagators, int k_max, const int n_pulses, const int n_pumps, const int n_potentials ) {
         this->use_twin_mode = use_twin_mode;
+        this->n_fft_propagators = n_fft_propagators;
         this->k_max = k_max;
         this->use_fft = use_fft;
         this->use_stochastic = use_stochastic;
+        this->use_dense_output = use_dense_output;
+        this->multi_rate = multi_rate;
+        this->twin_stack = use_twin_mode ? 2 : 1;
+        this->halo = halo;
+        this->k_stack = halo > 0 ? 1 : twin_stack;
+        this->N2 = N_x * N_y;
         #define DEFINE_MATRIX(type, ptrstruct, name, size_scaling, condition_for_construction) \
-            name.constructHost( N_x, N_y * size_scaling, #name); \
-            if (condition_for_construction) \
-                name.constructDevice( N_x, N_y * size_scaling, #name); 
-            //if (not std::is_same<type, Type::cuda_random_state>::value) \
-            //    name.fill(type(0.0));
+            if (condition_for_construction) { \
+                name.constructHost( N_x, N_y * size_scaling, #name); \
+                if (ptrstruct) \
+                    name.constructDevice( N_x, N_y * size_scaling, #name, halo ); \
+            }
         MATRIX_LIST
         #undef X
      }
@@ -138,12 +198,19 @@ struct MatrixContainer {
     Pointers pointers() {
         Pointers ptrs;
         #define DEFINE_MATRIX(type, ptrstruct, name, size_scaling, condition_for_construction) \
-            if (condition_for_construction) \
+            if (ptrstruct and condition_for_construction) \
                 ptrs.name = name.getDevicePtr(); \
             else \
                 ptrs.name = nullptr;
         MATRIX_LIST
         #undef X
+
+        // Set the minus pointers of stacked matrices, unless the minus matrix is constructed separately
+        #define DEFINE_STACKED_MATRIX(name_plus, name_minus) \
+            if ( ptrs.name_minus == nullptr ) \
+                ptrs.name_minus = ( use_twin_mode and ptrs.name_plus != nullptr ) ? ptrs.name_plus + N2 : nullptr;
+        STACKED_MATRIX_LIST
+        #undef DEFINE_STACKED_MATRIX
         
         return ptrs;
     }
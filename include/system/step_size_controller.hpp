@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <limits>
+
+#include "cuda/typedef.cuh"
+
+namespace PC3 {
+
+/**
+ * Step size controller for the adaptive Runge-Kutta iterators. The error passed to the controller
+ * is the weighted RMS norm of the local error, which is already scaled by the absolute and relative
+ * tolerances. Hence, a step is accepted if error <= 1. The next timestep is
+ * ------------------------------------------------------------------------------
+ * dt_next = dt * safety * e_n^(-b1/k) * e_n-1^(-b2/k) * e_n-2^(-b3/k)
+ * ------------------------------------------------------------------------------
+ * using the errors e of the current and the two previously accepted steps and k = embedded_order + 1.
+ * I:   b = ( 1, 0, 0 )            -> Elementary controller
+ * PI:  b = ( 0.7, -0.4, 0 )       -> Gustafsson PI controller
+ * PID: b = ( 1/4, 1/2, 1/4 )      -> Soederlind H312 controller
+ * The factor dt_next / dt is bounded by [min_factor, max_factor] and is not allowed to increase the
+ * timestep directly after a rejection. Rejected steps are retried using the elementary controller.
+ */
+class StepSizeController {
+    public:
+    enum class Mode {
+        I,
+        PI,
+        PID
+    };
+    static inline std::map<std::string, Mode> ModeFromString = {
+        { "i", Mode::I },
+        { "pi", Mode::PI },
+        { "pid", Mode::PID },
+    };
+    Mode mode = Mode::PI;
+    Type::real safety = 0.9;
+    Type::real min_factor = 0.2;
+    Type::real max_factor = 5.0;
+
+    // Statistics
+    unsigned int accepted_steps = 0;
+    unsigned int rejected_steps = 0;
+    Type::real last_dt = 0.0;
+    Type::real smallest_dt = std::numeric_limits<Type::real>::max();
+    Type::real largest_dt = 0.0;
+
+    /**
+     * Evaluates the error of a step with timestep dt. Returns true if the step is accepted.
+     * The timestep for the next step or the retry is written to next_dt and is bounded by dt_min and dt_max.
+     * Steps with dt <= dt_min are always accepted.
+     */
+    bool update( Type::real error, Type::real dt, int embedded_order, Type::real dt_min, Type::real dt_max, Type::real& next_dt );
+
+    // True if the controller was used by an iterator
+    bool isUsed() const;
+
+    std::string toString() const;
+
+    private:
+    // Errors of the two previously accepted steps
+    Type::real previous_errors[2] = { 1.0, 1.0 };
+    bool last_step_rejected = false;
+};
+
+} // namespace PC3
@@ -10,6 +10,7 @@
 #include "cuda/typedef.cuh"
 #include "system/filehandler.hpp"
 #include "system/envelope.hpp"
+#include "system/step_size_controller.hpp"
 
 namespace PC3 {
 
@@ -51,6 +52,13 @@ class SystemParameters {
         // Twin Mode
         bool use_twin_mode;
 
+        // Advance the reservoir using its exact solution instead of the RK stages. Only used by the RK tableau iterators.
+        bool multi_rate;
+
+        // The device matrices are padded by two rows in front of and behind the grid, see MatrixContainer.
+        // The neighbour stencils then skip the bounds checks in y. Only used by the RK tableau iterators.
+        bool halo_padding;
+
         ////////////////////////////////
         // Custom Parameters go here! //
         ////////////////////////////////
@@ -66,9 +74,24 @@ class SystemParameters {
 
     // RK Solver Variables
     Type::real t_max, dt_max, dt_min, tolerance, fft_every, random_system_amplitude, magic_timestep;
+    // Absolute and relative tolerances of the adaptive RK error norm
+    Type::real absolute_tolerance, relative_tolerance;
+    // Include the reservoir in the adaptive RK error norm
+    bool error_norm_reservoir;
+    // Step size controller and accept/reject statistics of the adaptive RK iterators
+    StepSizeController step_size_controller;
+    // Replace the magic timestep by the stability limit of the iterator, scaled by auto_dt_safety
+    bool auto_dt;
+    Type::real auto_dt_safety;
 
     // Kernel Block Size
     unsigned int block_size, omp_max_threads;
+    // Threads generating the noise of the next iteration in the background. 0 generates the noise synchronously.
+    unsigned int noise_threads;
+    // Cache blocked wavefront sweep of the fixed timestep RK iterators on the CPU. Band height in rows (0 chooses
+    // the height from the grid width) and largest number of timesteps fused into one sweep.
+    bool wavefront;
+    unsigned int wavefront_rows, wavefront_steps;
 
     // Initialize the system randomly
     bool randomly_initialize_system;
@@ -85,12 +108,19 @@ class SystemParameters {
     unsigned int history_output_n, history_y, history_matrix_start_x, history_matrix_start_y, history_matrix_end_x, history_matrix_end_y, history_matrix_output_increment;
     bool do_output_history_matrix;
     Type::real output_every;
+    // Interpolate the state at the output times instead of shortening the timestep. Only used by the RK tableau iterators.
+    bool dense_output;
 
     bool do_overwrite_dt;
 
     // Imag Time Amp
     Type::real imag_time_amplitude;
 
+    // FFT Backend. The planner rigor and the wisdom file are only used by the CPU FFT
+    std::string fft_planner, fft_wisdom_file;
+    // Apply the FFT mask within the linear SSFM step instead of a separate FFT round trip
+    bool fft_mask_in_ssfm;
+
     // Output of Variables
     std::vector<std::string> output_keys;
 
@@ -1,68 +1,29 @@
 #include "kernel/kernel_compute.cuh"
 #include "kernel/kernel_hamilton.cuh"
+#include "kernel/kernel_gp_rhs.cuh"
 #include "kernel/kernel_index_overwrite.cuh"
 
-/**
- * Mode without TE/TM Splitting
- * The differential equation for this model reduces to
- * ...
- */
 PULSE_GLOBAL void PC3::Kernel::Compute::gp_scalar( int i, Type::real t, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p_in, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io ) {
     
     LOCAL_SHARE_STRUCT( SystemParameters::KernelParameters, p_in, p );
 
     OVERWRITE_THREAD_INDEX( i );
 
-    const Type::complex in_wf = io.in_wf_plus[i];
-    const Type::complex in_rv = io.in_rv_plus[i];
-
-    Type::complex hamilton = p.m2_over_dx2_p_dy2 * in_wf;
-    hamilton += PC3::Kernel::Hamilton::scalar_neighbours( io.in_wf_plus, i, i / p.N_x /*Row*/, i % p.N_x /*Col*/, p.N_x, p.N_y, p.one_over_dx2, p.one_over_dy2, p.periodic_boundary_x, p.periodic_boundary_y );
-
-    const Type::real in_psi_norm = CUDA::abs2( in_wf );
-    
-    // MARK: Wavefunction
-    Type::complex result = p.minus_i_over_h_bar_s * ( p.m_eff_scaled * hamilton );
-
-    for (int k = 0; k < oscillation_potential.n; k++) {
-        const size_t offset = k * p.N_x * p.N_y;
-        const Type::complex potential = dev_ptrs.potential_plus[i+offset] * oscillation_potential.amp[k];
-        result += p.minus_i_over_h_bar_s * potential * in_wf;
-    }
-
-    result += p.minus_i_over_h_bar_s * p.g_c * in_psi_norm * in_wf;
-    result += p.minus_i_over_h_bar_s * p.g_r * in_rv * in_wf;
-    result += Type::real(0.5) * p.R * in_rv * in_wf;
-    result -= Type::real(0.5) * p.gamma_c * in_wf;
+    gp_scalar_rhs( i, dev_ptrs, p, oscillation_pulse, oscillation_pump, oscillation_potential, io, io.out_wf_plus[i], io.out_rv_plus[i] );
+}
 
-    // MARK: Pulse
-    for (int k = 0; k < oscillation_pulse.n; k++) {
-        const size_t offset = k * p.N_x * p.N_y;
-        const Type::complex pulse = dev_ptrs.pulse_plus[i+offset];
-        result += p.one_over_h_bar_s * pulse * oscillation_pulse.amp[k];
-    }
-    
-    // MARK: Stochastic
-    if (p.stochastic_amplitude > 0.0) {
-        const Type::complex dw = dev_ptrs.random_number[i] * CUDA::sqrt( ( p.R * in_rv + p.gamma_c ) / (Type::real(4.0) * p.dV) );
-        result -= p.minus_i_over_h_bar_s * p.g_c * in_wf / p.dV - dw / p.dt;
-    }
-    
-    io.out_wf_plus[i] = result;
+/**
+ * 2N-storage RK stage. Evaluates K, updates the register K1 and writes the next state.
+ */
+PULSE_GLOBAL void PC3::Kernel::Compute::gp_scalar_low_storage( int i, Type::real t, Type::complex dt, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p_in, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io, RK::LowStorageStage stage ) {
     
-    // MARK: Reservoir
-    result = -p.gamma_r * in_rv;
-    result -= p.R * in_psi_norm * in_rv;
-    for (int k = 0; k < oscillation_pump.n; k++) {
-        const int offset = k * p.N_x * p.N_y;
-            result += dev_ptrs.pump_plus[i+offset] * oscillation_pump.amp[k];
-    }
+    LOCAL_SHARE_STRUCT( SystemParameters::KernelParameters, p_in, p );
 
-    // MARK: Stochastic-2
-    if (p.stochastic_amplitude > 0.0)
-        result += p.R * in_rv / p.dV;
-    io.out_rv_plus[i] = result;
+    OVERWRITE_THREAD_INDEX( i );
 
+    Type::complex k_wf, k_rv;
+    gp_scalar_rhs( i, dev_ptrs, p, oscillation_pulse, oscillation_pump, oscillation_potential, io, k_wf, k_rv );
+    RK::low_storage_sum( i, dt, dev_ptrs, io, stage, k_wf, k_rv, false );
 }
 
 /**
@@ -71,7 +32,11 @@ PULSE_GLOBAL void PC3::Kernel::Compute::gp_scalar( int i, Type::real t, MatrixCo
  * Fourier Method (SSFM)
 */
 
-PULSE_GLOBAL void PC3::Kernel::Compute::gp_scalar_linear_fourier( int i, Type::real t, Type::complex dtc, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io ) {
+/**
+ * Calculates the linear k-space propagator exp(-i E(k) dtc / hbar) once. The SSFM then
+ * only multiplies the transformed wavefunction with this cached propagator.
+ */
+PULSE_GLOBAL void PC3::Kernel::Compute::gp_scalar_linear_propagator( int i, Type::real t, Type::complex dtc, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io ) {
     
     OVERWRITE_THREAD_INDEX( i );
 
@@ -83,16 +48,25 @@ PULSE_GLOBAL void PC3::Kernel::Compute::gp_scalar_linear_fourier( int i, Type::r
     const Type::real k_y = 2.0*3.1415926535 * Type::real(row <= p.N_y/2 ? row : -Type::real(p.N_y) + row)/p.L_y;
 
     Type::real linear = p.h_bar_s/2.0/p.m_eff * (k_x*k_x + k_y*k_y);
-    io.out_wf_plus[i] = io.in_wf_plus[i] / Type::real(p.N2) * CUDA::exp( p.minus_i * linear * dtc / Type::real(2.0) );
+    dev_ptrs.fft_propagator[i] = CUDA::exp( p.minus_i * linear * dtc );
 }
 
-PULSE_GLOBAL void PC3::Kernel::Compute::gp_scalar_nonlinear( int i, Type::real t, Type::complex dtc, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io ) {
+PULSE_GLOBAL void PC3::Kernel::Compute::gp_scalar_linear_fourier( int i, Type::real t, Type::complex dtc, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io ) {
     
     OVERWRITE_THREAD_INDEX( i );
-    
-    const Type::complex in_wf = io.in_wf_plus[i];
-    const Type::complex in_rv = io.in_rv_plus[i];
-    const Type::real in_psi_norm = CUDA::abs2( in_wf );
+
+    // If set, apply the pre-shifted FFT mask, which already contains the 1/N normalization
+    const Type::complex in_wf = dev_ptrs.fft_mask_plus == nullptr ? io.in_wf_plus[i] / Type::real(p.N2) : io.in_wf_plus[i] * dev_ptrs.fft_mask_plus[i];
+    io.out_wf_plus[i] = in_wf * dev_ptrs.fft_propagator[i];
+}
+
+/**
+ * Nonlinear step from the state in_wf, in_rv using the nonlinear coefficients evaluated
+ * at the state coeff_wf, coeff_rv. For the regular nonlinear step, both states are identical.
+ */
+PULSE_DEVICE PULSE_INLINE void gp_scalar_nonlinear_step( int i, PC3::Type::complex dtc, PC3::MatrixContainer::Pointers& dev_ptrs, PC3::SystemParameters::KernelParameters& p, PC3::Solver::TemporalEvelope::Pointers& oscillation_pump, PC3::Solver::TemporalEvelope::Pointers& oscillation_potential, const PC3::Type::complex in_wf, const PC3::Type::complex in_rv, const PC3::Type::complex coeff_wf, const PC3::Type::complex coeff_rv, PC3::Type::complex& out_wf, PC3::Type::complex& out_rv ) {
+    using namespace PC3;
+    const Type::real in_psi_norm = CUDA::abs2( coeff_wf );
     
     // MARK: Wavefunction
     Type::complex result = {p.g_c * in_psi_norm, -p.h_bar_s * Type::real(0.5) * p.gamma_c};
@@ -103,28 +77,51 @@ PULSE_GLOBAL void PC3::Kernel::Compute::gp_scalar_nonlinear( int i, Type::real t
         result += potential;
     }
 
-    result += p.g_r * in_rv;
-    result += p.i * p.h_bar_s * Type::real(0.5) * p.R * in_rv;
+    result += p.g_r * coeff_rv;
+    result += p.i * p.h_bar_s * Type::real(0.5) * p.R * coeff_rv;
 
     // MARK: Stochastic
     if (p.stochastic_amplitude > 0.0) {
-        const Type::complex dw = dev_ptrs.random_number[i] * CUDA::sqrt( ( p.R * in_rv + p.gamma_c ) / (Type::real(4.0) * p.dV) );
+        const Type::complex dw = dev_ptrs.random_number[i] * CUDA::sqrt( ( p.R * coeff_rv + p.gamma_c ) * p.dt / (Type::real(4.0) * p.dV) );
         result -= p.g_c / p.dV;
     }
 
-    io.out_wf_plus[i] = in_wf * CUDA::exp(p.minus_i_over_h_bar_s * result * dtc);
+    out_wf = in_wf * CUDA::exp(p.minus_i_over_h_bar_s * result * dtc);
 
     // MARK: Reservoir
-    result = -p.gamma_r * in_rv;
-    result -= p.R * in_psi_norm * in_rv;
+    result = -p.gamma_r * coeff_rv;
+    result -= p.R * in_psi_norm * coeff_rv;
     for (int k = 0; k < oscillation_pump.n; k++) {
         const int offset = k * p.N_x * p.N_y;
         result += dev_ptrs.pump_plus[i+offset] * oscillation_pump.amp[k]; //CUDA::gaussian_oscillator(t, oscillation_pump.t0[k], oscillation_pump.sigma[k], oscillation_pump.freq[k]);
     }
     // MARK: Stochastic-2
     if (p.stochastic_amplitude > 0.0)
-        result += p.R * in_rv / p.dV;
-    io.out_rv_plus[i] = in_rv + result * dtc;
+        result += p.R * coeff_rv / p.dV;
+    out_rv = in_rv + result * dtc;
+}
+
+PULSE_GLOBAL void PC3::Kernel::Compute::gp_scalar_nonlinear( int i, Type::real t, Type::complex dtc, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io ) {
+    
+    OVERWRITE_THREAD_INDEX( i );
+    
+    const Type::complex in_wf = io.in_wf_plus[i];
+    const Type::complex in_rv = io.in_rv_plus[i];
+    gp_scalar_nonlinear_step( i, dtc, dev_ptrs, p, oscillation_pump, oscillation_potential, in_wf, in_rv, in_wf, in_rv, io.out_wf_plus[i], io.out_rv_plus[i] );
+}
+
+/**
+ * Second order nonlinear step using the exponential midpoint rule. The outputs have to
+ * hold the state after a regular nonlinear step of dtc/2, which provides the nonlinear
+ * coefficients for the full step from the inputs. The outputs are overwritten.
+ */
+PULSE_GLOBAL void PC3::Kernel::Compute::gp_scalar_nonlinear_midpoint( int i, Type::real t, Type::complex dtc, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io ) {
+    
+    OVERWRITE_THREAD_INDEX( i );
+    
+    const Type::complex mid_wf = io.out_wf_plus[i];
+    const Type::complex mid_rv = io.out_rv_plus[i];
+    gp_scalar_nonlinear_step( i, dtc, dev_ptrs, p, oscillation_pump, oscillation_potential, io.in_wf_plus[i], io.in_rv_plus[i], mid_wf, mid_rv, io.out_wf_plus[i], io.out_rv_plus[i] );
 }
 
 PULSE_GLOBAL void PC3::Kernel::Compute::gp_scalar_independent( int i, Type::real t, Type::complex dtc, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io ) {
@@ -142,7 +139,7 @@ PULSE_GLOBAL void PC3::Kernel::Compute::gp_scalar_independent( int i, Type::real
     // MARK: Stochastic
     if (p.stochastic_amplitude > 0.0) {
         const Type::complex in_rv = io.in_rv_plus[i];
-        const Type::complex dw = dev_ptrs.random_number[i] * CUDA::sqrt( ( p.R * in_rv + p.gamma_c ) / (Type::real(4.0) * p.dV) );
+        const Type::complex dw = dev_ptrs.random_number[i] * CUDA::sqrt( ( p.R * in_rv + p.gamma_c ) * p.dt / (Type::real(4.0) * p.dV) );
         result += dw;
     }
     io.out_wf_plus[i] = io.in_wf_plus[i] + result;
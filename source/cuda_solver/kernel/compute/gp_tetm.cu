@@ -1,5 +1,6 @@
 #include "kernel/kernel_compute.cuh"
 #include "kernel/kernel_hamilton.cuh"
+#include "kernel/kernel_gp_rhs.cuh"
 #include "kernel/kernel_index_overwrite.cuh"
 
 PULSE_GLOBAL void PC3::Kernel::Compute::gp_tetm( int i, Type::real t, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p_in, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io ) {
@@ -8,117 +9,22 @@ PULSE_GLOBAL void PC3::Kernel::Compute::gp_tetm( int i, Type::real t, MatrixCont
     
     OVERWRITE_THREAD_INDEX( i );
 
-    const int row = i / p.N_x;
-    const int col = i % p.N_x;
-
-    const auto in_wf_plus = io.in_wf_plus[i];
-    const auto in_wf_minus = io.in_wf_minus[i];
-
-    Type::complex hamilton_regular_plus = p.m2_over_dx2_p_dy2 * in_wf_plus;
-    Type::complex hamilton_regular_minus = p.m2_over_dx2_p_dy2 * in_wf_minus;
-    Type::complex hamilton_cross_plus, hamilton_cross_minus;
-    PC3::Kernel::Hamilton::tetm_neighbours_plus( hamilton_regular_plus, hamilton_cross_minus, io.in_wf_plus, i, row, col, p.N_x, p.N_y, p.dx, p.dy, p.periodic_boundary_x, p.periodic_boundary_y );
-    PC3::Kernel::Hamilton::tetm_neighbours_minus( hamilton_regular_minus, hamilton_cross_plus, io.in_wf_minus, i, row, col, p.N_x, p.N_y, p.dx, p.dy, p.periodic_boundary_x, p.periodic_boundary_y );
-
-    const auto in_rv_plus = io.in_rv_plus[i];
-    const auto in_rv_minus = io.in_rv_minus[i];
-    const Type::real in_psi_plus_norm = CUDA::abs2( in_wf_plus );
-    const Type::real in_psi_minus_norm = CUDA::abs2( in_wf_minus );
- 
-    // MARK: Wavefunction Plus
-    Type::complex result = p.minus_i_over_h_bar_s * p.m_eff_scaled * hamilton_regular_plus;
-    
-    for (int k = 0; k < oscillation_potential.n; k++) {
-        const size_t offset = k * p.N_x * p.N_y;
-        const Type::complex potential = dev_ptrs.potential_plus[i+offset] * oscillation_potential.amp[k];
-        result += p.minus_i_over_h_bar_s * potential * in_wf_plus;
-    }
-
-    result += p.minus_i_over_h_bar_s * p.g_c * in_psi_plus_norm * in_wf_plus;
-    result += p.minus_i_over_h_bar_s * p.g_r * in_rv_plus * in_wf_plus;
-    result += Type::real(0.5) * p.R * in_rv_plus * in_wf_plus;
-    result -= Type::real(0.5)* p.gamma_c * in_wf_plus;
-
-    result += p.minus_i_over_h_bar_s * p.g_pm * in_psi_minus_norm * in_wf_plus;
-    result += p.minus_i_over_h_bar_s * p.delta_LT * hamilton_cross_plus;
-    
-    // MARK: Pulse Plus
-    for (int k = 0; k < oscillation_pulse.n; k++) {
-        const size_t offset = k * p.N_x * p.N_y;
-        const Type::complex pulse = dev_ptrs.pulse_plus[i+offset];
-        result += p.one_over_h_bar_s * pulse * oscillation_pulse.amp[k];
-    }
-
-    // MARK: Stochastic
-    if (p.stochastic_amplitude > 0.0) {
-        const Type::complex dw = dev_ptrs.random_number[i] * CUDA::sqrt( ( p.R * in_rv_plus + p.gamma_c ) / (Type::real(4.0) * p.dV) );
-        result -= p.minus_i_over_h_bar_s * p.g_c * in_wf_plus / p.dV - dw / p.dt;
-    }
-
-    io.out_wf_plus[i] = result;
-
-    // MARK: Reservoir Plus
-    result = -( p.gamma_r + p.R * in_psi_plus_norm ) * in_rv_plus;
-
-    for (int k = 0; k < oscillation_pump.n; k++) {
-        const size_t offset = k * p.N_x * p.N_y;
-        const auto gauss = oscillation_pump.amp[k];
-        result += dev_ptrs.pump_plus[i+offset] * gauss;
-    }
-
-    // MARK: Stochastic-2
-    if (p.stochastic_amplitude > 0.0)
-        result += p.R * in_rv_plus / p.dV;
+    gp_tetm_rhs( i, dev_ptrs, p, oscillation_pulse, oscillation_pump, oscillation_potential, io, io.out_wf_plus[i], io.out_wf_minus[i], io.out_rv_plus[i], io.out_rv_minus[i] );
+}
 
-    io.out_rv_plus[i] = result;
+/**
+ * 2N-storage RK stage. Evaluates K, updates the register K1 and writes the next state.
+ */
+PULSE_GLOBAL void PC3::Kernel::Compute::gp_tetm_low_storage( int i, Type::real t, Type::complex dt, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p_in, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io, RK::LowStorageStage stage ) {
     
-
-    // MARK: Wavefunction Minus
-    result = p.minus_i_over_h_bar_s * p.m_eff_scaled * hamilton_regular_minus;
+    LOCAL_SHARE_STRUCT( SystemParameters::KernelParameters, p_in, p );
     
-    for (int k = 0; k < oscillation_potential.n; k++) {
-        const size_t offset = k * p.N_x * p.N_y;
-        const Type::complex potential = dev_ptrs.potential_minus[i+offset] * oscillation_potential.amp[k];
-        result += p.minus_i_over_h_bar_s * potential * in_wf_minus;
-    }
-
-    result += p.minus_i_over_h_bar_s * p.g_c * in_psi_minus_norm * in_wf_minus;
-    result += p.minus_i_over_h_bar_s * p.g_r * in_rv_minus * in_wf_minus;
-    result += Type::real(0.5) * p.R * in_rv_minus * in_wf_minus;
-    result -= Type::real(0.5) * p.gamma_c * in_wf_minus;
- 
-    result += p.minus_i_over_h_bar_s * p.g_pm * in_psi_plus_norm * in_wf_minus;
-    result += p.minus_i_over_h_bar_s * p.delta_LT * hamilton_cross_minus;
-
-    // MARK: Pulse Minus
-    for (int k = 0; k < oscillation_pulse.n; k++) {
-        const size_t offset = k * p.N_x * p.N_y;
-        const Type::complex pulse = dev_ptrs.pulse_minus[i+offset];
-        result += p.one_over_h_bar_s * pulse * oscillation_pulse.amp[k];
-    }
-
-    if (p.stochastic_amplitude > 0.0) {
-        const Type::complex dw = dev_ptrs.random_number[i] * CUDA::sqrt( ( p.R * in_rv_minus + p.gamma_c ) / (Type::real(4.0) * p.dV) );
-        result -= p.minus_i_over_h_bar_s * p.g_c * in_wf_minus / p.dV - dw / p.dt;
-    }
-
-    io.out_wf_minus[i] = result;
-
-    // MARK: Reservoir Minus
-    result = -( p.gamma_r + p.R * in_psi_minus_norm ) * in_rv_minus;
-
-    for (int k = 0; k < oscillation_pump.n; k++) {
-        const size_t offset = k * p.N_x * p.N_y;
-        const auto gauss = oscillation_pump.amp[k];
-        result += dev_ptrs.pump_minus[i+offset] * gauss;
-    }
-
-    // MARK: Stochastic-2
-    if (p.stochastic_amplitude > 0.0)
-        result += p.R * in_rv_minus / p.dV;
-
-    io.out_rv_minus[i] = result;
+    OVERWRITE_THREAD_INDEX( i );
 
+    Type::complex k_wf_plus, k_wf_minus, k_rv_plus, k_rv_minus;
+    gp_tetm_rhs( i, dev_ptrs, p, oscillation_pulse, oscillation_pump, oscillation_potential, io, k_wf_plus, k_wf_minus, k_rv_plus, k_rv_minus );
+    RK::low_storage_sum( i, dt, dev_ptrs, io, stage, k_wf_plus, k_rv_plus, false );
+    RK::low_storage_sum( i, dt, dev_ptrs, io, stage, k_wf_minus, k_rv_minus, true );
 }
 
 /**
@@ -127,7 +33,16 @@ PULSE_GLOBAL void PC3::Kernel::Compute::gp_tetm( int i, Type::real t, MatrixCont
  * Fourier Method (SSFM)
 */
 
-PULSE_GLOBAL void PC3::Kernel::Compute::gp_tetm_linear_fourier( int i, Type::real t, Type::complex dtc, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io ) {
+/**
+ * Calculates the linear k-space propagator including the TE/TM splitting once.
+ * In k-space, the TE/TM coupling of the real space stencil (see Hamilton::tetm_neighbours_plus and
+ * tetm_neighbours_minus) reads -delta_LT (k_x -+ i k_y)^2, such that the linear part is
+ * H = E(k) + [[0, -delta_LT (k_x-ik_y)^2], [-delta_LT (k_x+ik_y)^2, 0]].
+ * Its exponential is exp(-iE(k)dtc/hbar) * [[cos(theta), i sin(theta) e^{-2i phi}], [i sin(theta) e^{2i phi}, cos(theta)]]
+ * with theta = delta_LT k^2 dtc / hbar and e^{2i phi} = (k_x+ik_y)^2/k^2. The three grids of the
+ * propagator hold the diagonal, the plus-minus and the minus-plus element.
+ */
+PULSE_GLOBAL void PC3::Kernel::Compute::gp_tetm_linear_propagator( int i, Type::real t, Type::complex dtc, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io ) {
     
     OVERWRITE_THREAD_INDEX( i );
 
@@ -137,92 +52,114 @@ PULSE_GLOBAL void PC3::Kernel::Compute::gp_tetm_linear_fourier( int i, Type::rea
     
     const Type::real k_x = 2.0*3.1415926535 * Type::real(col <= p.N_x/2 ? col : -Type::real(p.N_x) + col)/p.L_x;
     const Type::real k_y = 2.0*3.1415926535 * Type::real(row <= p.N_y/2 ? row : -Type::real(p.N_y) + row)/p.L_y;
+    const Type::real k2 = k_x*k_x + k_y*k_y;
 
-    Type::real linear = p.h_bar_s/2.0/p.m_eff * (k_x*k_x + k_y*k_y);
-    io.out_wf_plus[i] = io.in_wf_plus[i] / Type::real(p.N2) * CUDA::exp( p.minus_i * linear * dtc / Type::real(2.0) );
-    io.out_wf_minus[i] = io.in_wf_minus[i] / Type::real(p.N2) * CUDA::exp( p.minus_i * linear * dtc / Type::real(2.0) );
+    Type::real linear = p.h_bar_s/2.0/p.m_eff * k2;
+    const Type::complex kinetic = CUDA::exp( p.minus_i * linear * dtc );
+    const Type::complex theta = p.delta_LT * k2 * dtc / p.h_bar_s;
+    
+    dev_ptrs.fft_propagator[i] = kinetic * CUDA::cos( theta );
+    if ( k2 == 0.0 ) {
+        dev_ptrs.fft_propagator[i + p.N2] = 0.0;
+        dev_ptrs.fft_propagator[i + 2 * p.N2] = 0.0;
+        return;
+    }
+    // (k_x + i k_y)^2 / k^2
+    const Type::complex phase = Type::complex( k_x*k_x - k_y*k_y, Type::real(2.0) * k_x * k_y ) / k2;
+    const Type::complex off_diagonal = kinetic * p.i * CUDA::sin( theta );
+    dev_ptrs.fft_propagator[i + p.N2] = off_diagonal * Type::complex( CUDA::real( phase ), -CUDA::imag( phase ) );
+    dev_ptrs.fft_propagator[i + 2 * p.N2] = off_diagonal * phase;
 }
 
-PULSE_GLOBAL void PC3::Kernel::Compute::gp_tetm_nonlinear( int i, Type::real t, Type::complex dtc, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io ) {
+PULSE_GLOBAL void PC3::Kernel::Compute::gp_tetm_linear_fourier( int i, Type::real t, Type::complex dtc, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io ) {
     
     OVERWRITE_THREAD_INDEX( i );
+
+    // If set, apply the pre-shifted FFT mask, which already contains the 1/N normalization
+    const Type::complex in_wf_plus = dev_ptrs.fft_mask_plus == nullptr ? io.in_wf_plus[i] / Type::real(p.N2) : io.in_wf_plus[i] * dev_ptrs.fft_mask_plus[i];
+    const Type::complex in_wf_minus = dev_ptrs.fft_mask_minus == nullptr ? io.in_wf_minus[i] / Type::real(p.N2) : io.in_wf_minus[i] * dev_ptrs.fft_mask_minus[i];
+    const Type::complex propagator_diagonal = dev_ptrs.fft_propagator[i];
+    io.out_wf_plus[i] = propagator_diagonal * in_wf_plus + dev_ptrs.fft_propagator[i + p.N2] * in_wf_minus;
+    io.out_wf_minus[i] = dev_ptrs.fft_propagator[i + 2 * p.N2] * in_wf_plus + propagator_diagonal * in_wf_minus;
+}
+
+/**
+ * Nonlinear step of a single component from the state in_wf, in_rv using the nonlinear
+ * coefficients evaluated at the state coeff_wf, coeff_rv and the norm of the other
+ * component coeff_cross_norm. For the regular nonlinear step, both states are identical.
+ */
+PULSE_DEVICE PULSE_INLINE void gp_tetm_nonlinear_step( int i, PC3::Type::complex dtc, PC3::MatrixContainer::Pointers& dev_ptrs, PC3::SystemParameters::KernelParameters& p, PC3::Solver::TemporalEvelope::Pointers& oscillation_pump, PC3::Solver::TemporalEvelope::Pointers& oscillation_potential, PC3::Type::complex* potential, PC3::Type::complex* pump, const PC3::Type::complex in_wf, const PC3::Type::complex in_rv, const PC3::Type::complex coeff_wf, const PC3::Type::complex coeff_rv, const PC3::Type::real coeff_cross_norm, PC3::Type::complex& out_wf, PC3::Type::complex& out_rv ) {
+    using namespace PC3;
+    const Type::real in_psi_norm = CUDA::abs2( coeff_wf );
     
-    const Type::complex in_wf_plus = io.in_wf_plus[i];
-    const Type::complex in_rv_plus = io.in_rv_plus[i];
-    const Type::complex in_wf_minus = io.in_wf_minus[i];
-    const Type::complex in_rv_minus = io.in_rv_minus[i];
-    const Type::real in_psi_plus_norm = CUDA::abs2( in_wf_plus );
-    const Type::real in_psi_minus_norm = CUDA::abs2( in_wf_minus );
-    
-    // MARK: Wavefunction Plus
-    Type::complex result = {p.g_c * in_psi_plus_norm, -p.h_bar_s * Type::real(0.5) * p.gamma_c};
+    // MARK: Wavefunction
+    Type::complex result = {p.g_c * in_psi_norm, -p.h_bar_s * Type::real(0.5) * p.gamma_c};
 
     for (int k = 0; k < oscillation_potential.n; k++) {
         const size_t offset = k * p.N_x * p.N_y;
-        const Type::complex potential = dev_ptrs.potential_plus[i+offset] * oscillation_potential.amp[k]; //CUDA::gaussian_oscillator(t, oscillation_potential.t0[k], oscillation_potential.sigma[k], oscillation_potential.freq[k]);
-        result += potential;
+        result += potential[i+offset] * oscillation_potential.amp[k]; //CUDA::gaussian_oscillator(t, oscillation_potential.t0[k], oscillation_potential.sigma[k], oscillation_potential.freq[k]);
     }
 
-    result += p.g_r * in_rv_plus;
-    result += p.i * p.h_bar_s * Type::real(0.5) * p.R * in_rv_plus;
+    result += p.g_r * coeff_rv;
+    result += p.i * p.h_bar_s * Type::real(0.5) * p.R * coeff_rv;
 
-    Type::complex cross = p.g_pm * in_psi_minus_norm;
-    //cross += p.delta_LT * hamilton_cross_plus;
+    Type::complex cross = p.g_pm * coeff_cross_norm;
+    //cross += p.delta_LT * hamilton_cross;
 
     // MARK: Stochastic
     if (p.stochastic_amplitude > 0.0) {
-        const Type::complex dw = dev_ptrs.random_number[i] * CUDA::sqrt( ( p.R * in_rv_plus + p.gamma_c ) / (Type::real(4.0) * p.dV) );
+        const Type::complex dw = dev_ptrs.random_number[i] * CUDA::sqrt( ( p.R * coeff_rv + p.gamma_c ) * p.dt / (Type::real(4.0) * p.dV) );
         result -= p.g_c / p.dV;
     }
 
-    io.out_wf_plus[i] = in_wf_plus * CUDA::exp(p.minus_i_over_h_bar_s * ( result + cross) * dtc);
+    out_wf = in_wf * CUDA::exp(p.minus_i_over_h_bar_s * ( result + cross ) * dtc);
 
     // MARK: Reservoir
-    result = -p.gamma_r * in_rv_plus;
-    result -= p.R * in_psi_plus_norm * in_rv_plus;
+    result = -p.gamma_r * coeff_rv;
+    result -= p.R * in_psi_norm * coeff_rv;
     for (int k = 0; k < oscillation_pump.n; k++) {
         const int offset = k * p.N_x * p.N_y;
-        result += dev_ptrs.pump_plus[i+offset] * oscillation_pump.amp[k]; //CUDA::gaussian_oscillator(t, oscillation_pump.t0[k], oscillation_pump.sigma[k], oscillation_pump.freq[k]);
+        result += pump[i+offset] * oscillation_pump.amp[k]; //CUDA::gaussian_oscillator(t, oscillation_pump.t0[k], oscillation_pump.sigma[k], oscillation_pump.freq[k]);
     }
     // MARK: Stochastic-2
     if (p.stochastic_amplitude > 0.0)
-        result += p.R * in_rv_plus / p.dV;
-    io.out_rv_plus[i] = in_rv_plus + result * dtc;
-
-    // MARK: Wavefunction Minus
-    result = Type::complex(p.g_c * in_psi_minus_norm, -p.h_bar_s * Type::real(0.5) * p.gamma_c);
-
-    for (int k = 0; k < oscillation_potential.n; k++) {
-        const size_t offset = k * p.N_x * p.N_y;
-        const Type::complex potential = dev_ptrs.potential_minus[i+offset] * oscillation_potential.amp[k]; //CUDA::gaussian_oscillator(t, oscillation_potential.t0[k], oscillation_potential.sigma[k], oscillation_potential.freq[k]);
-        result += potential;
-    }
-
-    result += p.g_r * in_rv_minus;
-    result += p.i * p.h_bar_s * Type::real(0.5) * p.R * in_rv_minus;
-
-    cross = p.g_pm * in_psi_plus_norm;
-    //cross += p.delta_LT * hamilton_cross_minus;
-
-    // MARK: Stochastic
-    if (p.stochastic_amplitude > 0.0) {
-        const Type::complex dw = dev_ptrs.random_number[i] * CUDA::sqrt( ( p.R * in_rv_minus + p.gamma_c ) / (Type::real(4.0) * p.dV) );
-        result -= p.g_c / p.dV;
-    }
+        result += p.R * coeff_rv / p.dV;
+    out_rv = in_rv + result * dtc;
+}
 
-    io.out_wf_minus[i] = in_wf_minus * CUDA::exp(p.minus_i_over_h_bar_s * ( result + cross ) * dtc);
+PULSE_GLOBAL void PC3::Kernel::Compute::gp_tetm_nonlinear( int i, Type::real t, Type::complex dtc, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io ) {
+    
+    OVERWRITE_THREAD_INDEX( i );
+    
+    const Type::complex in_wf_plus = io.in_wf_plus[i];
+    const Type::complex in_rv_plus = io.in_rv_plus[i];
+    const Type::complex in_wf_minus = io.in_wf_minus[i];
+    const Type::complex in_rv_minus = io.in_rv_minus[i];
+    
+    // MARK: Plus
+    gp_tetm_nonlinear_step( i, dtc, dev_ptrs, p, oscillation_pump, oscillation_potential, dev_ptrs.potential_plus, dev_ptrs.pump_plus, in_wf_plus, in_rv_plus, in_wf_plus, in_rv_plus, CUDA::abs2( in_wf_minus ), io.out_wf_plus[i], io.out_rv_plus[i] );
+    // MARK: Minus
+    gp_tetm_nonlinear_step( i, dtc, dev_ptrs, p, oscillation_pump, oscillation_potential, dev_ptrs.potential_minus, dev_ptrs.pump_minus, in_wf_minus, in_rv_minus, in_wf_minus, in_rv_minus, CUDA::abs2( in_wf_plus ), io.out_wf_minus[i], io.out_rv_minus[i] );
+}
 
-    // MARK: Reservoir
-    result = -p.gamma_r * in_rv_minus;
-    result -= p.R * in_psi_minus_norm * in_rv_minus;
-    for (int k = 0; k < oscillation_pump.n; k++) {
-        const int offset = k * p.N_x * p.N_y;
-        result += dev_ptrs.pump_minus[i+offset] * oscillation_pump.amp[k]; //CUDA::gaussian_oscillator(t, oscillation_pump.t0[k], oscillation_pump.sigma[k], oscillation_pump.freq[k]);
-    }
-    // MARK: Stochastic-2
-    if (p.stochastic_amplitude > 0.0)
-        result += p.R * in_rv_minus / p.dV;
-    io.out_rv_minus[i] = in_rv_minus + result * dtc;
+/**
+ * Second order nonlinear step using the exponential midpoint rule. The outputs have to
+ * hold the state after a regular nonlinear step of dtc/2, which provides the nonlinear
+ * coefficients for the full step from the inputs. The outputs are overwritten.
+ */
+PULSE_GLOBAL void PC3::Kernel::Compute::gp_tetm_nonlinear_midpoint( int i, Type::real t, Type::complex dtc, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io ) {
+    
+    OVERWRITE_THREAD_INDEX( i );
+    
+    const Type::complex mid_wf_plus = io.out_wf_plus[i];
+    const Type::complex mid_rv_plus = io.out_rv_plus[i];
+    const Type::complex mid_wf_minus = io.out_wf_minus[i];
+    const Type::complex mid_rv_minus = io.out_rv_minus[i];
+    
+    // MARK: Plus
+    gp_tetm_nonlinear_step( i, dtc, dev_ptrs, p, oscillation_pump, oscillation_potential, dev_ptrs.potential_plus, dev_ptrs.pump_plus, io.in_wf_plus[i], io.in_rv_plus[i], mid_wf_plus, mid_rv_plus, CUDA::abs2( mid_wf_minus ), io.out_wf_plus[i], io.out_rv_plus[i] );
+    // MARK: Minus
+    gp_tetm_nonlinear_step( i, dtc, dev_ptrs, p, oscillation_pump, oscillation_potential, dev_ptrs.potential_minus, dev_ptrs.pump_minus, io.in_wf_minus[i], io.in_rv_minus[i], mid_wf_minus, mid_rv_minus, CUDA::abs2( mid_wf_plus ), io.out_wf_minus[i], io.out_rv_minus[i] );
 }
 
 PULSE_GLOBAL void PC3::Kernel::Compute::gp_tetm_independent( int i, Type::real t, Type::complex dtc, MatrixContainer::Pointers dev_ptrs, SystemParameters::KernelParameters p, Solver::TemporalEvelope::Pointers oscillation_pulse, Solver::TemporalEvelope::Pointers oscillation_pump, Solver::TemporalEvelope::Pointers oscillation_potential, InputOutput io ) {
@@ -240,7 +177,7 @@ PULSE_GLOBAL void PC3::Kernel::Compute::gp_tetm_independent( int i, Type::real t
     }
     if (p.stochastic_amplitude > 0.0) {
         const Type::complex in_rv = io.in_rv_plus[i];
-        const Type::complex dw = dev_ptrs.random_number[i] * CUDA::sqrt( ( p.R * in_rv + p.gamma_c ) / (Type::real(4.0) * p.dV) );
+        const Type::complex dw = dev_ptrs.random_number[i] * CUDA::sqrt( ( p.R * in_rv + p.gamma_c ) * p.dt / (Type::real(4.0) * p.dV) );
         result += dw;
     }
     io.out_wf_plus[i] = io.in_wf_plus[i] + result;
@@ -256,7 +193,7 @@ PULSE_GLOBAL void PC3::Kernel::Compute::gp_tetm_independent( int i, Type::real t
     }
     if (p.stochastic_amplitude > 0.0) {
         const Type::complex in_rv = io.in_rv_minus[i];
-        const Type::complex dw = dev_ptrs.random_number[i] * CUDA::sqrt( ( p.R * in_rv + p.gamma_c ) / (Type::real(4.0) * p.dV) );
+        const Type::complex dw = dev_ptrs.random_number[i] * CUDA::sqrt( ( p.R * in_rv + p.gamma_c ) * p.dt / (Type::real(4.0) * p.dV) );
         result += dw;
     }
     io.out_wf_minus[i] = io.in_wf_minus[i] + result;
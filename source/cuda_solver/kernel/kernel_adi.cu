@@ -0,0 +1,57 @@
+#include "cuda/typedef.cuh"
+#include "kernel/kernel_compute.cuh"
+#include "kernel/kernel_index_overwrite.cuh"
+
+/**
+ * Single Peaceman-Rachford sweep for line i. The line is implicit along the direction with n
+ * points and stride stride_implicit and explicit along the m lines with stride stride_explicit.
+ * Solves (1 - r_implicit D_implicit) out = (1 + r_explicit D_explicit) in using the Thomas
+ * algorithm with the precomputed line coefficients. Periodic lines are corrected using the
+ * Sherman-Morrison formula. in and out have to be different matrices, because the explicit
+ * part reads the neighbouring lines.
+ */
+PULSE_GLOBAL void PC3::Kernel::ADI::adi_sweep( int i, Type::complex* PULSE_RESTRICT in, Type::complex* PULSE_RESTRICT out, Type::complex* coefficients, Type::complex r_implicit, Type::complex r_explicit, const int n, const int stride_implicit, const int m, const int stride_explicit, const bool periodic_implicit, const bool periodic_explicit ) {
+    GET_THREAD_INDEX( i, m );
+
+    const Type::complex* c_prime = coefficients;
+    const Type::complex* inv_m = coefficients + n;
+    const Type::complex* z = coefficients + 2 * n;
+
+    const int base = i * stride_explicit;
+    // Neighbouring lines of the explicit part. Without periodic boundaries, the outer neighbours are zero.
+    const bool has_previous = i > 0 or periodic_explicit;
+    const bool has_next = i < m - 1 or periodic_explicit;
+    const int offset_previous = i > 0 ? -stride_explicit : ( m - 1 ) * stride_explicit;
+    const int offset_next = i < m - 1 ? stride_explicit : -( m - 1 ) * stride_explicit;
+
+    // Forward elimination. The sub-diagonal is -r_implicit.
+    Type::complex y = 0.0;
+    for ( int j = 0; j < n; j++ ) {
+        const int k = base + j * stride_implicit;
+        const Type::complex value = in[k];
+        Type::complex neighbours = Type::real( -2.0 ) * value;
+        if ( has_previous )
+            neighbours += in[k + offset_previous];
+        if ( has_next )
+            neighbours += in[k + offset_next];
+        y = ( value + r_explicit * neighbours + r_implicit * y ) * inv_m[j];
+        out[k] = y;
+    }
+
+    // Back substitution
+    for ( int j = n - 2; j >= 0; j-- ) {
+        const int k = base + j * stride_implicit;
+        out[k] -= c_prime[j] * out[k + stride_implicit];
+    }
+
+    if ( not periodic_implicit )
+        return;
+
+    // Sherman-Morrison correction for the cyclic corner elements
+    const Type::complex q = coefficients[3 * n];
+    const Type::complex inv_denominator = coefficients[3 * n + 1];
+    const Type::complex factor = ( out[base] + q * out[base + ( n - 1 ) * stride_implicit] ) * inv_denominator;
+    for ( int j = 0; j < n; j++ ) {
+        out[base + j * stride_implicit] -= factor * z[j];
+    }
+}
@@ -0,0 +1,13 @@
+#include "cuda/typedef.cuh"
+#include "kernel/kernel_compute.cuh"
+#include "kernel/kernel_index_overwrite.cuh"
+
+/**
+ * Periodic halo for column i. The row in front of the matrix holds the last row and the
+ * row behind the matrix holds the first row, so the stencils wrap around in y without checks.
+ */
+PULSE_GLOBAL void PC3::Kernel::fill_halo( int i, Type::complex* buffer, const int N_x, const int N_y ) {
+    GET_THREAD_INDEX( i, N_x );
+    buffer[i - N_x] = buffer[i + N_x * ( N_y - 1 )];
+    buffer[i + N_x * N_y] = buffer[i];
+}
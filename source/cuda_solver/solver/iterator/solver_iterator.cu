@@ -1,4 +1,5 @@
 #include <omp.h>
+#include <tuple>
 
 // Include Cuda Kernel headers
 #include "cuda/typedef.cuh"
@@ -15,7 +16,6 @@
 * locally to this file here.
 */
 PC3::Type::real fft_cached_t = 0.0;
-bool first_time = true;
 
 /**
  * Iterates the Runge-Kutta-Method on the GPU
@@ -34,27 +34,27 @@ bool PC3::Solver::iterate( ) {
     dim3 block_size( system.block_size, 1 );
     dim3 grid_size( ( system.p.N_x*system.p.N_y + block_size.x ) / block_size.x, 1 );
     
-    // If required, calculate new set of random numbers.
+    // If required, calculate new set of random numbers. The random numbers only depend on the seed, the iteration and the grid index,
+    // so the noise of the next iteration is generated in the background while this iteration runs. See solver/solver_noise.cu
     if (system.evaluateStochastic()) {
-        auto device_pointers = matrix.pointers();
-        if (first_time) {
-            first_time = false;
-            CALL_KERNEL(
-                    PC3::Kernel::initialize_random_number_generator, "random_number_init", grid_size, block_size,
-                    system.random_seed, device_pointers.random_state, system.p.N_x*system.p.N_y
-                );
-            std::cout << PC3::CLIO::prettyPrint( "Initialized Random Number Generator", PC3::CLIO::Control::Info ) << std::endl;
+        if ( noise_prefetched_iteration == system.iteration ) {
+            awaitNoise();
+            matrix.random_number.swap( matrix.random_number_next );
+        } else {
+            generateNoise( matrix.random_number.getDevicePtr(), system.iteration );
         }
-        CALL_KERNEL(
-            PC3::Kernel::generate_random_numbers, "random_number_gen", grid_size, block_size,
-            device_pointers.random_state, device_pointers.random_number, system.p.N_x*system.p.N_y, system.p.stochastic_amplitude*std::sqrt(system.p.dt), system.p.stochastic_amplitude*std::sqrt(system.p.dt)
-        );
+        if ( system.noise_threads > 0 )
+            prefetchNoise( system.iteration + 1 );
     }
 
     // Update the temporal envelopes
+    const auto previous_envelopes = std::make_tuple( system.pulse.temporal_envelope, system.potential.temporal_envelope, system.pump.temporal_envelope );
     system.pulse.updateTemporal( system.p.t );
     system.potential.updateTemporal( system.p.t );
     system.pump.updateTemporal( system.p.t );
+    // A cached first RK stage was evaluated using the previous envelopes
+    if ( previous_envelopes != std::make_tuple( system.pulse.temporal_envelope, system.potential.temporal_envelope, system.pump.temporal_envelope ) )
+        rk_first_stage_cached = false;
     // And update the solver struct accordingly
     dev_pulse_oscillation.amp.setTo( system.pulse.temporal_envelope );
     dev_potential_oscillation.amp.setTo( system.potential.temporal_envelope );
@@ -66,19 +66,28 @@ bool PC3::Solver::iterate( ) {
     if (system.imag_time_amplitude != 0.0) 
         normalizeImaginaryTimePropagation( block_size, grid_size );
 
-    // Increase t. 
-    system.p.t = system.p.t + system.p.dt;
+    // Increase t. The wavefront sweep may have advanced several timesteps.
+    for ( int step = 0; step < fused_steps; step++ )
+        system.p.t = system.p.t + system.p.dt;
+    // Adaptive iterators propose the timestep of the next iteration
+    if ( proposed_dt > 0.0 )
+        system.p.dt = proposed_dt;
     
     // For statistical purposes, increase the iteration counter
-    system.iteration++;
+    system.iteration += fused_steps;
+    fused_steps = 1;
 
-    // FFT Guard 
-    if ( system.p.t - fft_cached_t < system.fft_every )
+    // FFT Guard. Without a mask, the FFT is only calculated on demand for visualization.
+    if ( system.fft_mask.size() == 0 or system.p.t - fft_cached_t < system.fft_every )
         return true;
 
-    // Calculate the FFT
+    // Apply the FFT Filter. With -ssfmMask, the mask is instead multiplied into the next linear SSFM half step.
     fft_cached_t = system.p.t; 
-    applyFFTFilter( block_size, grid_size, system.fft_mask.size() > 0 );
+    if ( system.fft_mask_in_ssfm ) {
+        fft_mask_pending = true;
+        return true;
+    }
+    applyFFTFilter( block_size, grid_size );
 
     return true;
 }
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include <omp.h>
+
+// Include Cuda Kernel headers
+#include "cuda/typedef.cuh"
+#include "kernel/kernel_compute.cuh"
+#include "system/system_parameters.hpp"
+#include "misc/helperfunctions.hpp"
+#include "cuda/cuda_matrix.cuh"
+#include "solver/gpu_solver.hpp"
+#include "misc/commandline_io.hpp"
+
+/**
+ * Calculates the coefficients of the tridiagonal system (1 - r D) x = d with the constant
+ * diagonal 1 + 2r and off diagonals -r along a line of length n. Because the coefficients
+ * are the same for every line, the Thomas factors are only calculated once. For periodic
+ * lines, the modified system and the Sherman-Morrison correction vector z are stored as well.
+ */
+static void calculateLineCoefficients( PC3::Type::complex* coefficients, const PC3::Type::complex r, const int n, const bool periodic ) {
+    using PC3::Type::complex;
+    const complex b = complex( 1.0 ) + PC3::Type::real( 2.0 ) * r;
+    const complex off_diagonal = -r;
+    // Sherman-Morrison: A = A' + u v^T with u = (gamma, 0, ..., 0, -r) and v = (1, 0, ..., 0, -r/gamma)
+    const complex gamma = -b;
+    complex* c_prime = coefficients;
+    complex* inv_m = coefficients + n;
+    complex* z = coefficients + 2 * n;
+
+    for ( int j = 0; j < n; j++ ) {
+        complex diagonal = b;
+        if ( periodic and j == 0 )
+            diagonal = b - gamma;
+        if ( periodic and j == n - 1 )
+            diagonal = b - off_diagonal * off_diagonal / gamma;
+        const complex m = j == 0 ? diagonal : diagonal - off_diagonal * c_prime[j - 1];
+        inv_m[j] = complex( 1.0 ) / m;
+        c_prime[j] = off_diagonal * inv_m[j];
+    }
+
+    coefficients[3 * n] = 0.0;
+    coefficients[3 * n + 1] = 0.0;
+    if ( not periodic )
+        return;
+
+    // Solve A' z = u
+    for ( int j = 0; j < n; j++ ) {
+        const complex u = j == 0 ? gamma : ( j == n - 1 ? off_diagonal : complex( 0.0 ) );
+        z[j] = j == 0 ? u * inv_m[j] : ( u - off_diagonal * z[j - 1] ) * inv_m[j];
+    }
+    for ( int j = n - 2; j >= 0; j-- )
+        z[j] -= c_prime[j] * z[j + 1];
+    const complex q = off_diagonal / gamma;
+    coefficients[3 * n] = q;
+    coefficients[3 * n + 1] = complex( 1.0 ) / ( complex( 1.0 ) + z[0] + q * z[n - 1] );
+}
+
+void PC3::Solver::updateADICoefficients( Type::complex tau ) {
+    if ( tau == adi_tau and adi_coefficients.getTotalSize() > 0 )
+        return;
+    adi_tau = tau;
+
+    const auto& p = system.kernel_parameters;
+    // Each sweep is implicit for half of the linear sub-step
+    const Type::complex prefactor = p.minus_i_over_h_bar_s * p.m_eff_scaled * tau / Type::real( 2.0 );
+    const int size_x = Kernel::ADI::coefficient_size( p.N_x );
+    const int size_y = Kernel::ADI::coefficient_size( p.N_y );
+
+    Type::host_vector<Type::complex> coefficients( size_x + size_y );
+    calculateLineCoefficients( coefficients.data(), prefactor * p.one_over_dx2, p.N_x, p.periodic_boundary_x );
+    calculateLineCoefficients( coefficients.data() + size_x, prefactor * p.one_over_dy2, p.N_y, p.periodic_boundary_y );
+
+    if ( adi_coefficients.getTotalSize() == 0 )
+        adi_coefficients.construct( size_x + size_y, 1, "ADI Coefficients" );
+    adi_coefficients.setTo( coefficients );
+}
+
+/*
+ * Alternating Direction Implicit (ADI) method.
+ * The linear kinetic term is integrated using Peaceman-Rachford steps of the finite
+ * difference Laplacian, which are unconditionally stable and do not require periodic
+ * boundaries. The nonlinear and independent parts are handled by Strang splitting.
+ * ------------------------------------------------------------------------------
+ * L(tau): (1 - tau/2 a Dxx) psi* = (1 + tau/2 a Dyy) psi       -> Row sweeps
+ *         (1 - tau/2 a Dyy) psi' = (1 + tau/2 a Dxx) psi*      -> Column sweeps
+ * next = L(dt/2) I(dt) N(dt) L(dt/2) current
+ * ------------------------------------------------------------------------------
+ * with a = -i/hbar * m_eff_scaled. Each sweep solves one tridiagonal system per line.
+ * The lines are independent, so all rows or all columns are solved in parallel.
+ * Periodic boundaries lead to cyclic systems, which are solved using the Sherman-Morrison
+ * formula. The TE/TM coupling contains mixed derivatives and is not supported.
+ */
+void PC3::Solver::iterateAlternatingDirectionImplicit( dim3 block_size, dim3 grid_size ) {
+    // This variable contains all the system parameters the kernel could need
+    auto p = system.kernel_parameters;
+    Type::complex dt = system.imag_time_amplitude != 0.0 ? Type::complex( 0.0, -p.dt ) : Type::complex( p.dt, 0.0 );
+
+    // Cache the line coefficients for the linear half steps
+    updateADICoefficients( dt / Type::real( 2.0 ) );
+    Type::complex* coefficients_x = adi_coefficients.getDevicePtr();
+    Type::complex* coefficients_y = coefficients_x + Kernel::ADI::coefficient_size( p.N_x );
+    const Type::complex prefactor = p.minus_i_over_h_bar_s * p.m_eff_scaled * dt / Type::real( 4.0 );
+    const Type::complex r_x = prefactor * p.one_over_dx2;
+    const Type::complex r_y = prefactor * p.one_over_dy2;
+
+    // This variable contains all the device pointers the kernel could need
+    auto device_pointers = matrix.pointers();
+
+    // Pointers to Oscillation Parameters
+    auto pulse_pointers = dev_pulse_oscillation.pointers();
+    auto pump_pointers = dev_pump_oscillation.pointers();
+    auto potential_pointers = dev_potential_oscillation.pointers();
+
+    // Linear half step from in to out using K1 as intermediate buffer
+    auto linear_half_step = [&]( Type::complex* in, Type::complex* out ) {
+        CALL_LINE_KERNEL(
+            Kernel::ADI::adi_sweep, "adi_rows", p.N_y, block_size,
+            in, device_pointers.k1_wavefunction_plus, coefficients_x, r_x, r_y, p.N_x, 1, p.N_y, p.N_x, p.periodic_boundary_x, p.periodic_boundary_y
+        );
+        CALL_LINE_KERNEL(
+            Kernel::ADI::adi_sweep, "adi_columns", p.N_x, block_size,
+            device_pointers.k1_wavefunction_plus, out, coefficients_y, r_y, r_x, p.N_y, p.N_x, p.N_x, 1, p.periodic_boundary_y, p.periodic_boundary_x
+        );
+    };
+
+    linear_half_step( device_pointers.wavefunction_plus, device_pointers.k2_wavefunction_plus );
+
+    CALL_KERNEL(
+        RUNGE_FUNCTION_GP_NONLINEAR, "nonlinear_full_step", grid_size, block_size,
+        p.t, dt, device_pointers, p, pulse_pointers, pump_pointers, potential_pointers,
+        {
+            device_pointers.k2_wavefunction_plus, device_pointers.discard, device_pointers.reservoir_plus, device_pointers.discard,
+            device_pointers.k1_wavefunction_plus, device_pointers.discard, device_pointers.buffer_reservoir_plus, device_pointers.discard
+        }
+    );
+
+    CALL_KERNEL(
+        RUNGE_FUNCTION_GP_INDEPENDENT, "independent", grid_size, block_size,
+        p.t, dt, device_pointers, p, pulse_pointers, pump_pointers, potential_pointers,
+        {
+            device_pointers.k1_wavefunction_plus, device_pointers.discard, device_pointers.buffer_reservoir_plus, device_pointers.discard,
+            device_pointers.k2_wavefunction_plus, device_pointers.discard, device_pointers.discard, device_pointers.discard
+        }
+    );
+
+    linear_half_step( device_pointers.k2_wavefunction_plus, device_pointers.buffer_wavefunction_plus );
+
+    // Swap the next and current wavefunction buffers. This only swaps the pointers, not the data.
+    swapBuffers();
+
+    return;
+}
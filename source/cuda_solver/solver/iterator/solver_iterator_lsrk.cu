@@ -0,0 +1,79 @@
+#include <omp.h>
+
+// Include Cuda Kernel headers
+#include "cuda/typedef.cuh"
+#include "kernel/kernel_compute.cuh"
+#include "system/system_parameters.hpp"
+#include "misc/helperfunctions.hpp"
+#include "cuda/cuda_matrix.cuh"
+#include "solver/gpu_solver.hpp"
+#include "misc/commandline_io.hpp"
+
+void PC3::Solver::iterateLowStorageRungeKutta3( dim3 block_size, dim3 grid_size ) {
+    using T = Kernel::RK::Tableau::LowStorage3;
+    const static std::vector<Type::real> A( std::begin( T::A ), std::end( T::A ) );
+    const static std::vector<Type::real> B( std::begin( T::B ), std::end( T::B ) );
+    const static std::vector<Type::real> C( std::begin( T::C ), std::end( T::C ) );
+    iterateLowStorageRungeKutta( block_size, grid_size, A, B, C );
+}
+
+void PC3::Solver::iterateLowStorageRungeKutta4( dim3 block_size, dim3 grid_size ) {
+    using T = Kernel::RK::Tableau::LowStorage4;
+    const static std::vector<Type::real> A( std::begin( T::A ), std::end( T::A ) );
+    const static std::vector<Type::real> B( std::begin( T::B ), std::end( T::B ) );
+    const static std::vector<Type::real> C( std::begin( T::C ), std::end( T::C ) );
+    iterateLowStorageRungeKutta( block_size, grid_size, A, B, C );
+}
+
+/*
+ * 2N-storage Runge-Kutta method in Williamson form. Instead of keeping every K, a single
+ * register dU is carried from stage to stage:
+ * ------------------------------------------------------------------------------
+ * dU = A[s] * dU + dt * f(t + C[s] * dt, U)
+ * U = U + B[s] * dU
+ * ------------------------------------------------------------------------------
+ * The coefficients of the schemes are listed in kernel/kernel_runge_kutta_tableau.cuh.
+ * The register is the K1 matrix, so only a single K matrix is allocated. Because f
+ * reads the neighbours of U, the state cannot be updated in place. The stages instead
+ * alternate between the wavefunction and the buffer matrices, which both exist anyways.
+ */
+void PC3::Solver::iterateLowStorageRungeKutta( dim3 block_size, dim3 grid_size, const std::vector<Type::real>& A, const std::vector<Type::real>& B, const std::vector<Type::real>& C ) {
+    // This variable contains all the system parameters the kernel could need
+    auto p = system.kernel_parameters;
+    Type::complex dt = system.imag_time_amplitude != 0.0 ? Type::complex(0.0, -p.dt) : Type::complex(p.dt, 0.0);
+
+    // This variable contains all the device pointers the kernel could need
+    auto device_pointers = matrix.pointers();
+    Kernel::InputOutput current = {
+        device_pointers.wavefunction_plus, device_pointers.wavefunction_minus,
+        device_pointers.reservoir_plus, device_pointers.reservoir_minus,
+        device_pointers.buffer_wavefunction_plus, device_pointers.buffer_wavefunction_minus,
+        device_pointers.buffer_reservoir_plus, device_pointers.buffer_reservoir_minus
+    };
+    Kernel::InputOutput swapped = {
+        device_pointers.buffer_wavefunction_plus, device_pointers.buffer_wavefunction_minus,
+        device_pointers.buffer_reservoir_plus, device_pointers.buffer_reservoir_minus,
+        device_pointers.wavefunction_plus, device_pointers.wavefunction_minus,
+        device_pointers.reservoir_plus, device_pointers.reservoir_minus
+    };
+
+    // Pointers to Oscillation Parameters
+    auto pulse_pointers = dev_pulse_oscillation.pointers();
+    auto pump_pointers = dev_pump_oscillation.pointers();
+    auto potential_pointers = dev_potential_oscillation.pointers();
+
+    for ( int s = 0; s < A.size(); s++ ) {
+        CALL_KERNEL(
+            RUNGE_FUNCTION_GP_LOW_STORAGE, "low_storage_stage", grid_size, block_size,
+            p.t + C[s] * p.dt, dt, device_pointers, p, pulse_pointers, pump_pointers, potential_pointers,
+            s % 2 == 0 ? current : swapped,
+            { A[s], B[s] }
+        );
+    }
+
+    // After an odd number of stages, the result is in the buffer. Swap the next and current wavefunction buffers. This only swaps the pointers, not the data.
+    if ( A.size() % 2 == 1 )
+        swapBuffers();
+
+    return;
+}
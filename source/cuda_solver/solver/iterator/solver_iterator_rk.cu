@@ -0,0 +1,362 @@
+#include "cuda/typedef.cuh"
+
+#include <cmath>
+#include <omp.h>
+#include <array>
+#include <utility>
+#include <algorithm>
+#include <tuple>
+
+// Include Cuda Kernel headers
+#include "kernel/kernel_compute.cuh"
+#include "kernel/kernel_runge_kutta.cuh"
+#include "system/system_parameters.hpp"
+#include "misc/helperfunctions.hpp"
+#include "cuda/cuda_matrix.cuh"
+#include "solver/gpu_solver.hpp"
+#include "misc/commandline_io.hpp"
+
+void PC3::Solver::iterateFixedTimestepRungeKutta3( dim3 block_size, dim3 grid_size ) {
+    iterateFixedTimestepTableau<Kernel::RK::Tableau::RK3>( block_size, grid_size );
+}
+
+void PC3::Solver::iterateFixedTimestepRungeKutta4( dim3 block_size, dim3 grid_size ) {
+    iterateFixedTimestepTableau<Kernel::RK::Tableau::RK4>( block_size, grid_size );
+}
+
+void PC3::Solver::iterateVariableTimestepRungeKutta( dim3 block_size, dim3 grid_size ) {
+    iterateVariableTimestepTableau<Kernel::RK::Tableau::DP45>( block_size, grid_size );
+}
+
+void PC3::Solver::iterateVariableTimestepRungeKutta23( dim3 block_size, dim3 grid_size ) {
+    iterateVariableTimestepTableau<Kernel::RK::Tableau::BS32>( block_size, grid_size );
+}
+
+void PC3::Solver::iterateVariableTimestepTsitouras5( dim3 block_size, dim3 grid_size ) {
+    iterateVariableTimestepTableau<Kernel::RK::Tableau::Tsit5>( block_size, grid_size );
+}
+
+void PC3::Solver::denseOutputRungeKutta3( dim3 block_size, dim3 grid_size, Type::real t ) {
+    denseOutputTableau<Kernel::RK::Tableau::RK3>( block_size, grid_size, t );
+}
+
+void PC3::Solver::denseOutputRungeKutta4( dim3 block_size, dim3 grid_size, Type::real t ) {
+    denseOutputTableau<Kernel::RK::Tableau::RK4>( block_size, grid_size, t );
+}
+
+void PC3::Solver::denseOutputRungeKutta45( dim3 block_size, dim3 grid_size, Type::real t ) {
+    denseOutputTableau<Kernel::RK::Tableau::DP45>( block_size, grid_size, t );
+}
+
+void PC3::Solver::denseOutputRungeKutta23( dim3 block_size, dim3 grid_size, Type::real t ) {
+    denseOutputTableau<Kernel::RK::Tableau::BS32>( block_size, grid_size, t );
+}
+
+void PC3::Solver::denseOutputTsitouras5( dim3 block_size, dim3 grid_size, Type::real t ) {
+    denseOutputTableau<Kernel::RK::Tableau::Tsit5>( block_size, grid_size, t );
+}
+
+/*
+ * Launches the fused stage kernels of the tableau T. Stage S evaluates
+ * ------------------------------------------------------------------------------
+ * k_S = f(t + c_S * dt, input_S)
+ * input_S+1 = current + dt * sum_n a_S+1,n * k_n
+ * next = current + dt * sum_n b_n * k_n   (accumulated stage by stage, or input_s-1 for FSAL tableaus)
+ * ------------------------------------------------------------------------------
+ * The K and input locations are determined at compile time by the tableau, see kernel/kernel_runge_kutta_tableau.cuh.
+ * The final result always ends up in the buffer.
+ */
+template <class T, int S>
+void PC3::Solver::calculateTableauStages( dim3 block_size, dim3 grid_size, SystemParameters::KernelParameters& p, Type::complex dt ) {
+    // This variable contains all the device pointers the kernel could need
+    auto device_pointers = matrix.pointers();
+
+    // Pointers to Oscillation Parameters
+    auto pulse_pointers = dev_pulse_oscillation.pointers();
+    auto pump_pointers = dev_pump_oscillation.pointers();
+    auto potential_pointers = dev_potential_oscillation.pointers();
+
+    // The last stage of an adaptive tableau reduces the scaled error into the partial sums
+    Kernel::RK::ErrorNorm norm;
+    if constexpr ( T::adaptive )
+        norm = { rk_partial_sums.getDevicePtr(), system.absolute_tolerance, system.relative_tolerance, system.error_norm_reservoir };
+
+    // The stencils of this stage read the halo of its input
+    constexpr int input = Kernel::RK::Tableau::input_location<T>( S );
+    fillHalo( Kernel::RK::wavefunction_at<input>( device_pointers, false ), Kernel::RK::wavefunction_at<input>( device_pointers, true ) );
+
+    CALL_KERNEL(
+        RUNGE_FUNCTION_GP_TABLEAU( T, S ), "Stage", grid_size, block_size,
+        p.t + T::c[S] * p.dt, dt, device_pointers, p, pulse_pointers, pump_pointers, potential_pointers, norm
+    );
+
+    if constexpr ( S + 1 < T::stages )
+        calculateTableauStages<T, S + 1>( block_size, grid_size, p, dt );
+}
+
+/*
+ * Iterates the Runge Kutta tableau T using a fixed time step.
+ */
+template <class T>
+void PC3::Solver::iterateFixedTimestepTableau( dim3 block_size, dim3 grid_size ) {
+    static_assert( Kernel::RK::Tableau::is_consistent<T>() );
+    // This variable contains all the system parameters the kernel could need
+    auto p = system.kernel_parameters;
+    Type::complex dt = system.imag_time_amplitude != 0.0 ? Type::complex(0.0, -p.dt) : Type::complex(p.dt, 0.0);
+
+#ifdef USE_CPU
+    if ( system.wavefront ) {
+        fused_steps = wavefrontSteps();
+        iterateWavefrontTableau<T>( p, dt, fused_steps );
+        // The dense output uses the last of the fused steps
+        for ( int step = 1; step < fused_steps; step++ )
+            p.t = p.t + p.dt;
+        dense_output_t0 = p.t;
+        dense_output_dt = p.dt;
+        dense_output_slopes_evaluated = false;
+        return;
+    }
+#endif
+
+    calculateTableauStages<T>( block_size, grid_size, p, dt );
+
+    // Swap the next and current wavefunction buffers. This only swaps the pointers, not the data.
+    swapBuffers();
+
+    dense_output_t0 = p.t;
+    dense_output_dt = p.dt;
+    dense_output_slopes_evaluated = false;
+}
+
+#ifdef USE_CPU
+// Evaluates stage S of the tableau T on the rows row_begin ... row_end - 1. The rows are shared by the threads of the enclosing parallel region.
+template <class T, int S, bool twin_mode>
+static void tableau_stage_rows( const int row_begin, const int row_end, PC3::Type::real t, PC3::Type::complex dt, const PC3::MatrixContainer::Pointers& dev_ptrs, const PC3::SystemParameters::KernelParameters& p, const PC3::Solver::TemporalEvelope::Pointers& oscillation_pulse, const PC3::Solver::TemporalEvelope::Pointers& oscillation_pump, const PC3::Solver::TemporalEvelope::Pointers& oscillation_potential, const PC3::Kernel::RK::ErrorNorm& norm ) {
+    // With periodic boundaries in y, the band spans the whole grid and the halo of the input is filled first, see Solver::fillHalo
+    if ( p.halo_padding and p.periodic_boundary_y ) {
+        constexpr int input = PC3::Kernel::RK::Tableau::input_location<T>( S );
+        auto ptrs = dev_ptrs;
+        PC3::Type::complex* input_plus = PC3::Kernel::RK::wavefunction_at<input>( ptrs, false );
+        PC3::Type::complex* input_minus = PC3::Kernel::RK::wavefunction_at<input>( ptrs, true );
+#pragma omp for schedule( static )
+        for ( int col = 0; col < p.N_x; col++ ) {
+            PC3::Kernel::fill_halo( col, input_plus, p.N_x, p.N_y );
+            if constexpr ( twin_mode )
+                PC3::Kernel::fill_halo( col, input_minus, p.N_x, p.N_y );
+        }
+    }
+#pragma omp for schedule( static )
+    for ( int row = row_begin; row < row_end; row++ )
+        for ( int col = 0; col < p.N_x; col++ ) {
+            if constexpr ( twin_mode )
+                PC3::Kernel::Compute::gp_tetm_tableau<T, S>( row * p.N_x + col, t, dt, dev_ptrs, p, oscillation_pulse, oscillation_pump, oscillation_potential, norm );
+            else
+                PC3::Kernel::Compute::gp_scalar_tableau<T, S>( row * p.N_x + col, t, dt, dev_ptrs, p, oscillation_pulse, oscillation_pump, oscillation_potential, norm );
+        }
+}
+
+// Row functions of the stages 0 ... T::stages - 1 of the tableau T, indexed by the stage
+template <class T, int... S>
+static auto tableau_stage_row_functions( const bool twin_mode, std::integer_sequence<int, S...> ) {
+    using StageRows = void ( * )( const int, const int, PC3::Type::real, PC3::Type::complex, const PC3::MatrixContainer::Pointers&, const PC3::SystemParameters::KernelParameters&, const PC3::Solver::TemporalEvelope::Pointers&, const PC3::Solver::TemporalEvelope::Pointers&, const PC3::Solver::TemporalEvelope::Pointers&, const PC3::Kernel::RK::ErrorNorm& );
+    return std::array<StageRows, sizeof...( S )>{ ( twin_mode ? StageRows( tableau_stage_rows<T, S, true> ) : StageRows( tableau_stage_rows<T, S, false> ) )... };
+}
+
+/*
+ * Cache blocked wavefront sweep over n_steps fixed timesteps of the tableau T. The grid is divided into
+ * bands of rows and stage S of step m is the pipeline stage q = m * T::stages + S. In every wave, pipeline
+ * stage q processes the band directly behind the band of pipeline stage q - 1:
+ * ------------------------------------------------------------------------------
+ * wave 0:  q=0 band 0
+ * wave 1:  q=0 band 1,  q=1 band 0
+ * wave 2:  q=0 band 2,  q=1 band 1,  q=2 band 0
+ * ------------------------------------------------------------------------------
+ * The stencil of a stage reaches one row into the next band, which the previous pipeline stage has already
+ * finished, and the rows a stage overwrites have already been read by all previous pipeline stages. The sweep
+ * therefore gives the same result as the full grid passes, while the rows written by a stage are still in the
+ * cache when the following stages read them. Odd steps read the state from the buffer and write to the
+ * wavefunction, so their wavefunction and buffer pointers are exchanged. With periodic boundaries in y,
+ * the first row requires the last row of the previous stage, and a single band spans the whole grid.
+ */
+template <class T>
+void PC3::Solver::iterateWavefrontTableau( SystemParameters::KernelParameters& p, Type::complex dt, const int n_steps ) {
+    const auto stage_rows = tableau_stage_row_functions<T>( p.use_twin_mode, std::make_integer_sequence<int, T::stages>() );
+
+    auto pointers = matrix.pointers();
+    auto swapped_pointers = pointers;
+    std::swap( swapped_pointers.wavefunction_plus, swapped_pointers.buffer_wavefunction_plus );
+    std::swap( swapped_pointers.reservoir_plus, swapped_pointers.buffer_reservoir_plus );
+    std::swap( swapped_pointers.wavefunction_minus, swapped_pointers.buffer_wavefunction_minus );
+    std::swap( swapped_pointers.reservoir_minus, swapped_pointers.buffer_reservoir_minus );
+    auto pulse_pointers = dev_pulse_oscillation.pointers();
+    auto pump_pointers = dev_pump_oscillation.pointers();
+    auto potential_pointers = dev_potential_oscillation.pointers();
+    const Kernel::RK::ErrorNorm norm;
+
+    // Kernel parameters of the fused steps. The time is advanced the same way as by Solver::iterate.
+    std::vector<SystemParameters::KernelParameters> step_parameters( n_steps, p );
+    for ( int step = 1; step < n_steps; step++ )
+        step_parameters[step].t = step_parameters[step - 1].t + p.dt;
+
+    const int N_y = p.N_y;
+    const int band = p.periodic_boundary_y ? N_y : wavefrontRows();
+    const int n_bands = ( N_y + band - 1 ) / band;
+    const int n_pipeline = n_steps * T::stages;
+
+#pragma omp parallel num_threads( system.omp_max_threads )
+    for ( int wave = 0; wave < n_bands + n_pipeline - 1; wave++ ) {
+        for ( int q = std::max( 0, wave - n_bands + 1 ); q <= std::min( wave, n_pipeline - 1 ); q++ ) {
+            const int step = q / T::stages;
+            const int stage = q % T::stages;
+            const auto& step_pointers = step % 2 ? swapped_pointers : pointers;
+            const auto& step_p = step_parameters[step];
+            const Type::real t = step_p.t + T::c[stage] * p.dt;
+            const int row_begin = ( wave - q ) * band;
+            stage_rows[stage]( row_begin, std::min( row_begin + band, N_y ), t, dt, step_pointers, step_p, pulse_pointers, pump_pointers, potential_pointers, norm );
+        }
+    }
+
+    // After an odd number of steps, the result is in the buffer
+    if ( n_steps % 2 )
+        swapBuffers();
+}
+#endif
+
+/*
+ * Steps are only fused if nothing happens between them: the noise, the imaginary time normalization and the
+ * FFT Filter are applied once per iteration, and the temporal envelopes have to stay the same. A fused step
+ * also has to end before the next output, so the main loop never shortens it.
+ */
+int PC3::Solver::wavefrontSteps() {
+    if ( system.evaluateStochastic() or system.imag_time_amplitude != 0.0 or system.fft_mask.size() > 0 )
+        return 1;
+    const auto envelopes = std::make_tuple( system.pulse.temporal_envelope, system.potential.temporal_envelope, system.pump.temporal_envelope );
+    int n_steps = 1;
+    Type::real t = system.p.t + system.p.dt;
+    while ( n_steps < system.wavefront_steps and t < system.t_max and t + system.p.dt <= next_output_time ) {
+        system.pulse.updateTemporal( t );
+        system.potential.updateTemporal( t );
+        system.pump.updateTemporal( t );
+        if ( envelopes != std::make_tuple( system.pulse.temporal_envelope, system.potential.temporal_envelope, system.pump.temporal_envelope ) )
+            break;
+        n_steps++;
+        t = t + system.p.dt;
+    }
+    system.pulse.updateTemporal( system.p.t );
+    system.potential.updateTemporal( system.p.t );
+    system.pump.updateTemporal( system.p.t );
+    return n_steps;
+}
+
+// Without --wavefront rows, a band of a single matrix holds 256 KiB, but every thread gets at least one row
+int PC3::Solver::wavefrontRows() {
+    if ( system.wavefront_rows > 0 )
+        return system.wavefront_rows;
+    const int rows = 262144 / ( system.p.N_x * sizeof( Type::complex ) );
+    return std::max<int>( rows, system.omp_max_threads );
+}
+
+/*
+ * Iterates the adaptive Runge Kutta tableau T using a variable time step.
+ * The last stage also evaluates the local error dt * sum_n e_n * k_n of the embedded method and
+ * reduces it into the weighted RMS norm
+ * ------------------------------------------------------------------------------
+ * error = sqrt( 1/N sum_i |e_i|^2 / ( atol + rtol * max(|current_i|, |next_i|) )^2 )
+ * ------------------------------------------------------------------------------
+ * over all grid points and components of the wavefunction and, optionally, the reservoir.
+ * For FSAL tableaus, k_0 is cached, so a rejected attempt and an accepted step both require
+ * one right hand side evaluation less than the number of stages.
+ * The step is accepted if error <= 1. The step size controller then proposes the timestep
+ * of the next iteration, which is stored in proposed_dt. Rejected steps are repeated with
+ * a smaller timestep. The timestep is always bounded by dt_min and dt_max.
+ */
+template <class T>
+void PC3::Solver::iterateVariableTimestepTableau( dim3 block_size, dim3 grid_size ) {
+    static_assert( T::adaptive and Kernel::RK::Tableau::is_consistent<T>() );
+    // Accept current step?
+    bool accept = false;
+
+    // The partial sums only hold a few values per block, so they are summed on the host
+    const int n_partial = Kernel::RK::partial_sum_count( system.p.N_y, grid_size.x );
+    if ( rk_partial_sums.getTotalSize() != Kernel::RK::n_reduced * n_partial )
+        rk_partial_sums.construct( Kernel::RK::n_reduced * n_partial, 1, "RK Partial Sums" );
+
+    do {
+        // We snapshot here to make sure that the dt is updated
+        auto p = system.kernel_parameters;
+        Type::complex dt = system.imag_time_amplitude != 0.0 ? Type::complex(0.0, -p.dt) : Type::complex(p.dt, 0.0);
+
+        // The first stage only depends on the current state. It is evaluated once and then reused by rejected attempts and, for FSAL tableaus, carried over from the last stage of the previous step.
+        if ( rk_first_stage_cached ) {
+            auto device_pointers = matrix.pointers();
+            CALL_KERNEL(
+                Kernel::Compute::gp_tableau_cached_first_stage<T>, "Cached Stage", grid_size, block_size,
+                dt, device_pointers, p
+            );
+            calculateTableauStages<T, 1>( block_size, grid_size, p, dt );
+        } else {
+            calculateTableauStages<T>( block_size, grid_size, p, dt );
+        }
+        // The stochastic contribution to the right hand side depends on dt and the random numbers of the current iteration
+        rk_first_stage_cached = T::fsal and not system.evaluateStochastic();
+
+        // Sum the partial scaled squared errors
+        const auto& partial_sums = rk_partial_sums.getHostVector();
+        Type::real error_sum = 0.0;
+        for ( int b = 0; b < n_partial; b++ )
+            error_sum += partial_sums[Kernel::RK::error_sum * n_partial + b];
+        const int n_values = p.N2 * ( p.use_twin_mode ? 2 : 1 ) * ( system.error_norm_reservoir ? 2 : 1 );
+        const Type::real final_error = std::sqrt( error_sum / n_values );
+
+        Type::real next_dt;
+        accept = system.step_size_controller.update( final_error, p.dt, T::embedded_order, system.dt_min, system.dt_max, next_dt );
+        if ( accept ) {
+            proposed_dt = next_dt;
+            // Swap the next and current wavefunction buffers. This only swaps the pointers, not the data.
+            swapBuffers();
+            // The last K of this step is the first K of the next step
+            if constexpr ( T::fsal )
+                swapKMatrices( Kernel::RK::Tableau::k_slot<T>( 0 ), Kernel::RK::Tableau::fsal_slot<T>() );
+            dense_output_t0 = p.t;
+            dense_output_dt = p.dt;
+        } else {
+            // Retry with the smaller timestep
+            system.p.dt = next_dt;
+        }
+    } while ( !accept );
+}
+
+/*
+ * Writes the state at the time t within the last step of the tableau T into the dense matrices,
+ * see Kernel::RK::dense_output. After the step, the previous state is still located in the buffer.
+ * FSAL tableaus keep the right hand sides of both states, so the interpolation does not require
+ * any additional evaluations. For other tableaus, they are evaluated once per step on demand.
+ * Because the temporal envelopes are only updated at the beginning of a step, the right hand side
+ * of the current state is evaluated using the envelopes of the last step, like the last stage.
+ */
+template <class T>
+void PC3::Solver::denseOutputTableau( dim3 block_size, dim3 grid_size, Type::real t ) {
+    auto p = system.kernel_parameters;
+    auto device_pointers = matrix.pointers();
+
+    if constexpr ( not T::fsal ) {
+        if ( not dense_output_slopes_evaluated ) {
+            // Pointers to Oscillation Parameters
+            auto pulse_pointers = dev_pulse_oscillation.pointers();
+            auto pump_pointers = dev_pump_oscillation.pointers();
+            auto potential_pointers = dev_potential_oscillation.pointers();
+            static_assert( Kernel::RK::Tableau::dense_slot<T>( 0 ) == 0 and Kernel::RK::Tableau::dense_slot<T>( T::stages - 1 ) == 1 );
+            fillHalo( device_pointers.buffer_wavefunction_plus, device_pointers.buffer_wavefunction_minus );
+            fillHalo( device_pointers.wavefunction_plus, device_pointers.wavefunction_minus );
+            CALCULATE_K( 1, dense_output_t0, buffer_wavefunction, buffer_reservoir );
+            CALCULATE_K( 2, dense_output_t0 + dense_output_dt, wavefunction, reservoir );
+            dense_output_slopes_evaluated = true;
+        }
+    }
+
+    const Type::real theta = ( t - dense_output_t0 ) / dense_output_dt;
+    CALL_KERNEL(
+        Kernel::Compute::gp_tableau_dense_output<T>, "Dense Output", grid_size, block_size,
+        theta, Type::complex( dense_output_dt, 0.0 ), device_pointers, p
+    );
+}
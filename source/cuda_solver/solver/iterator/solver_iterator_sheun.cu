@@ -0,0 +1,126 @@
+#include <omp.h>
+
+// Include Cuda Kernel headers
+#include "cuda/typedef.cuh"
+#include "kernel/kernel_compute.cuh"
+#include "system/system_parameters.hpp"
+#include "misc/helperfunctions.hpp"
+#include "cuda/cuda_matrix.cuh"
+#include "solver/gpu_solver.hpp"
+#include "misc/commandline_io.hpp"
+
+/*
+ * Integrating Factor (Lawson) Stochastic Heun method.
+ * The linear kinetic (and TE/TM) term L is propagated exactly in k-space using the
+ * cached propagator E = exp(L dt), while the remaining terms N (potential, nonlinearity,
+ * reservoir, pump, pulse and noise) are integrated using the twice iterated Heun method
+ * of Kernel::RK::Tableau::StochasticHeun in the interaction picture. The timestep is
+ * therefore only limited by the local rates and not by the kinetic term ~ dx^2.
+ * The noise increment is drawn once per step and enters every stage through N.
+ * The reservoir is not affected by L, so E acts only on the wavefunction.
+ * ------------------------------------------------------------------------------
+ * k1 = N(t, current)
+ * k2 = N(t + dt, E (current + dt * k1))
+ * Eh = E (current + 0.5 * dt * k1)
+ * k3 = N(t + dt, Eh + 0.5 * dt * k2)
+ * next = Eh + 0.5 * dt * k3
+ * ------------------------------------------------------------------------------
+ * Each iteration requires two FFT round trips. The k-space scratch buffer is K3,
+ * which is not in use during either propagation.
+ */
+void PC3::Solver::iterateIntegratingFactorStochasticHeun( dim3 block_size, dim3 grid_size ) {
+    Type::complex dt = system.imag_time_amplitude != 0.0 ? Type::complex( 0.0, -system.kernel_parameters.dt ) : Type::complex( system.kernel_parameters.dt, 0.0 );
+
+    // Cache the propagator for dt
+    updateFFTPropagator( block_size, grid_size, { dt } );
+
+    // This variable contains all the system parameters the kernel could need.
+    // The kinetic and TE/TM terms are handled by the propagator, so they are removed from the RK function.
+    auto p = system.kernel_parameters;
+    p.m_eff_scaled = 0.0;
+    p.delta_LT = 0.0;
+
+    // This variable contains all the device pointers the kernel could need
+    auto device_pointers = matrix.pointers();
+    Kernel::InputOutput io = {
+        device_pointers.wavefunction_plus, device_pointers.wavefunction_minus,
+        device_pointers.reservoir_plus, device_pointers.reservoir_minus,
+        device_pointers.buffer_wavefunction_plus, device_pointers.buffer_wavefunction_minus,
+        device_pointers.buffer_reservoir_plus, device_pointers.buffer_reservoir_minus
+    };
+
+    // Pointers to Oscillation Parameters
+    auto pulse_pointers = dev_pulse_oscillation.pointers();
+    auto pump_pointers = dev_pump_oscillation.pointers();
+    auto potential_pointers = dev_potential_oscillation.pointers();
+
+    // The FFT mask is never applied within the propagation
+    auto linear_pointers = device_pointers;
+    linear_pointers.fft_propagator = getFFTPropagator( 0 );
+    linear_pointers.fft_mask_plus = nullptr;
+    linear_pointers.fft_mask_minus = nullptr;
+
+    // Applies E in place to the wavefunction components plus and minus using the stacked scratch matrix
+    auto propagate = [&]( Type::complex* plus, Type::complex* minus, Type::complex* scratch ) {
+        calculateFFT( plus, scratch, FFT::forward );
+        if ( system.p.use_twin_mode )
+            calculateFFT( minus, scratch + system.p.N2, FFT::forward );
+        CALL_KERNEL(
+            RUNGE_FUNCTION_GP_LINEAR, "linear_propagator", grid_size, block_size,
+            p.t, dt, linear_pointers, p, pulse_pointers, pump_pointers, potential_pointers,
+            {
+                scratch, scratch + system.p.N2, device_pointers.discard, device_pointers.discard,
+                scratch, scratch + system.p.N2, device_pointers.discard, device_pointers.discard
+            }
+        );
+        calculateFFT( scratch, plus, FFT::inverse );
+        if ( system.p.use_twin_mode )
+            calculateFFT( scratch + system.p.N2, minus, FFT::inverse );
+    };
+
+    CALCULATE_K( 1, p.t, wavefunction, reservoir );
+
+    CALL_KERNEL(
+        Kernel::RK::runge_sum_to_input_kw, "Sum for K2", grid_size, block_size,
+        dt, device_pointers, p, io,
+        { 1.0 } // dt*K1
+    );
+    propagate( device_pointers.buffer_wavefunction_plus, device_pointers.buffer_wavefunction_minus, device_pointers.k3_wavefunction_plus );
+
+    CALCULATE_K( 2, p.t + p.dt, buffer_wavefunction, buffer_reservoir );
+
+    CALL_KERNEL(
+        Kernel::RK::runge_sum_to_input_kw, "Sum for Eh", grid_size, block_size,
+        dt, device_pointers, p, io,
+        { 0.5 } // 0.5*dt*K1
+    );
+    propagate( device_pointers.buffer_wavefunction_plus, device_pointers.buffer_wavefunction_minus, device_pointers.k3_wavefunction_plus );
+
+    // The current state is no longer required, so it holds the input for K3
+    CALL_KERNEL(
+        Kernel::RK::runge_sum_to_input_kw, "Sum for K3", grid_size, block_size,
+        dt, device_pointers, p,
+        {
+            device_pointers.buffer_wavefunction_plus, device_pointers.buffer_wavefunction_minus, device_pointers.buffer_reservoir_plus, device_pointers.buffer_reservoir_minus,
+            device_pointers.wavefunction_plus, device_pointers.wavefunction_minus, device_pointers.reservoir_plus, device_pointers.reservoir_minus
+        },
+        { 0.0, 0.5 } // 0.5*dt*K2
+    );
+
+    CALCULATE_K( 3, p.t + p.dt, wavefunction, reservoir );
+
+    CALL_KERNEL(
+        Kernel::RK::runge_sum_to_input_kw, "Final Sum", grid_size, block_size,
+        dt, device_pointers, p,
+        {
+            device_pointers.buffer_wavefunction_plus, device_pointers.buffer_wavefunction_minus, device_pointers.buffer_reservoir_plus, device_pointers.buffer_reservoir_minus,
+            device_pointers.buffer_wavefunction_plus, device_pointers.buffer_wavefunction_minus, device_pointers.buffer_reservoir_plus, device_pointers.buffer_reservoir_minus
+        },
+        { 0.0, 0.0, 0.5 } // 0.5*dt*K3
+    );
+
+    // Swap the next and current wavefunction buffers. This only swaps the pointers, not the data.
+    swapBuffers();
+
+    return;
+}
@@ -10,79 +10,249 @@
 #include "misc/commandline_io.hpp"
 
 /**
- * Split Step Fourier Method
+ * Rebuilds the cached linear k-space propagators for the (possibly complex) linear sub-steps dts.
+ * The propagators only depend on dt, so they are only recalculated when dt changes.
  */
-void PC3::Solver::iterateSplitStepFourier( dim3 block_size, dim3 grid_size ) {
-    
+void PC3::Solver::updateFFTPropagator( dim3 block_size, dim3 grid_size, const std::vector<Type::complex>& dts ) {
+    fft_propagator_dt.resize( dts.size(), Type::complex( 0.0, 0.0 ) );
+
     auto p = system.kernel_parameters;
-    Type::complex dt = system.imag_time_amplitude != 0.0 ? Type::complex(0.0, -p.dt) : Type::complex(p.dt, 0.0);
-    
-    // This variable contains all the device pointers the kernel could need
     auto device_pointers = matrix.pointers();
+    auto pulse_pointers = dev_pulse_oscillation.pointers();
+    auto pump_pointers = dev_pump_oscillation.pointers();
+    auto potential_pointers = dev_potential_oscillation.pointers();
 
-    // Pointers to Oscillation Parameters
+    for ( int n = 0; n < dts.size(); n++ ) {
+        if ( dts[n] == fft_propagator_dt[n] )
+            continue;
+        fft_propagator_dt[n] = dts[n];
+        device_pointers.fft_propagator = getFFTPropagator( n );
+        CALL_KERNEL(
+            RUNGE_FUNCTION_GP_PROPAGATOR, "linear_propagator", grid_size, block_size, 
+            p.t, dts[n], device_pointers, p, pulse_pointers, pump_pointers, potential_pointers,
+            { 
+                device_pointers.discard, device_pointers.discard, device_pointers.discard, device_pointers.discard,
+                device_pointers.discard, device_pointers.discard, device_pointers.discard, device_pointers.discard
+            }
+        );
+    }
+}
+
+PC3::Type::complex* PC3::Solver::getFFTPropagator( int index ) {
+    return matrix.fft_propagator.getDevicePtr() + index * ( system.p.use_twin_mode ? 3 : 1 ) * system.p.N2;
+}
+
+/**
+ * Applies a deferred linear half step to the wavefunction. The SSFM defers the trailing
+ * linear half step of each iteration and fuses it with the leading half step of the next
+ * iteration. Whenever the synchronized wavefunction is required, the pending half step
+ * is applied here instead.
+ */
+void PC3::Solver::flushPendingHalfStep() {
+    if ( not ssfm_half_step_pending )
+        return;
+    ssfm_half_step_pending = false;
+
+    dim3 block_size( system.block_size, 1 );
+    dim3 grid_size( ( system.p.N_x*system.p.N_y + block_size.x ) / block_size.x, 1 );
+
+    auto p = system.kernel_parameters;
+    // The deferred half step always uses the first propagator
+    auto device_pointers = matrix.pointers();
+    device_pointers.fft_propagator = getFFTPropagator( 0 );
+    device_pointers.fft_mask_plus = nullptr;
+    device_pointers.fft_mask_minus = nullptr;
     auto pulse_pointers = dev_pulse_oscillation.pointers();
     auto pump_pointers = dev_pump_oscillation.pointers();
     auto potential_pointers = dev_potential_oscillation.pointers();
 
-    // Liner Half Step
-    // Calculate the FFT of Psi
     calculateFFT( device_pointers.wavefunction_plus, device_pointers.k1_wavefunction_plus, FFT::forward );
     if (system.p.use_twin_mode)
         calculateFFT( device_pointers.wavefunction_minus, device_pointers.k1_wavefunction_minus, FFT::forward );
     CALL_KERNEL(
         RUNGE_FUNCTION_GP_LINEAR, "linear_half_step", grid_size, block_size, 
-        p.t, dt, device_pointers, p, pulse_pointers, pump_pointers, potential_pointers,
+        p.t, fft_propagator_dt[0], device_pointers, p, pulse_pointers, pump_pointers, potential_pointers,
         { 
             device_pointers.k1_wavefunction_plus, device_pointers.k1_wavefunction_minus, device_pointers.discard, device_pointers.discard,
             device_pointers.k2_wavefunction_plus, device_pointers.k2_wavefunction_minus, device_pointers.discard, device_pointers.discard
         }
     );
-    // Transform back. K1 now holds the half-stepped wavefunction.
-    calculateFFT( device_pointers.k2_wavefunction_plus, device_pointers.k1_wavefunction_plus, FFT::inverse );
+    calculateFFT( device_pointers.k2_wavefunction_plus, device_pointers.wavefunction_plus, FFT::inverse );
     if (system.p.use_twin_mode)
-        calculateFFT( device_pointers.k2_wavefunction_minus, device_pointers.k1_wavefunction_minus, FFT::inverse );
+        calculateFFT( device_pointers.k2_wavefunction_minus, device_pointers.wavefunction_minus, FFT::inverse );
+}
 
-    // Nonlinear Full Step
-    CALL_KERNEL(
-        RUNGE_FUNCTION_GP_NONLINEAR, "nonlinear_full_step", grid_size, block_size, 
-        p.t, dt, device_pointers, p, pulse_pointers, pump_pointers, potential_pointers,
-        { 
-            device_pointers.k1_wavefunction_plus, device_pointers.k1_wavefunction_minus, device_pointers.reservoir_plus, device_pointers.reservoir_minus,
-            device_pointers.k2_wavefunction_plus, device_pointers.k2_wavefunction_minus, device_pointers.buffer_reservoir_plus, device_pointers.buffer_reservoir_minus
-        }
-    );
-    // K2 now holds the nonlinearly evolved wavefunction.
+/**
+ * Split Step Fourier Method
+ * The Strang step is ordered as linear half step, nonlinear full step, independent part
+ * and linear half step. The trailing linear half step is deferred, such that two consecutive
+ * half steps are fused into a single full step using only one FFT round trip.
+ */
+void PC3::Solver::iterateSplitStepFourier( dim3 block_size, dim3 grid_size ) {
+    iterateSplitStepComposition( block_size, grid_size, { 1.0 } );
+}
+
+/**
+ * Fourth order Split Step Fourier Method using the symmetric composition of three
+ * Strang steps by Yoshida (Phys. Lett. A 150, 262 (1990)).
+ */
+void PC3::Solver::iterateSplitStepFourier4( dim3 block_size, dim3 grid_size ) {
+    const static Type::real w1 = 1.0 / ( 2.0 - std::cbrt( 2.0 ) );
+    const static Type::real w0 = 1.0 - 2.0 * w1;
+    iterateSplitStepComposition( block_size, grid_size, { w1, w0, w1 } );
+}
 
-    // Liner Half Step 
+/**
+ * Sixth order Split Step Fourier Method using the symmetric composition of seven
+ * Strang steps by Yoshida (solution A).
+ */
+void PC3::Solver::iterateSplitStepFourier6( dim3 block_size, dim3 grid_size ) {
+    const static Type::real w1 = -1.17767998417887;
+    const static Type::real w2 = 0.235573213359357;
+    const static Type::real w3 = 0.784513610477560;
+    const static Type::real w0 = 1.0 - 2.0 * ( w1 + w2 + w3 );
+    iterateSplitStepComposition( block_size, grid_size, { w3, w2, w1, w0, w1, w2, w3 } );
+}
+
+/**
+ * Composition of Strang steps S(weights[n-1]*dt) ... S(weights[0]*dt). Consecutive linear
+ * half steps are merged, such that the linear sub-steps are
+ * weights[0]/2, (weights[0]+weights[1])/2, ..., (weights[n-2]+weights[n-1])/2, weights[n-1]/2.
+ * The weights have to be symmetric with an odd number of weights. The propagators are cached as
+ * 0: weights[0]*dt/2 (leading and deferred trailing half step)
+ * 1: weights[0]*dt (fused trailing and leading half step of two iterations)
+ * 1+k: (weights[k-1]+weights[k])*dt/2 (inner linear steps)
+ */
+void PC3::Solver::iterateSplitStepComposition( dim3 block_size, dim3 grid_size, const std::vector<Type::real>& weights ) {
+    
+    auto p = system.kernel_parameters;
+    Type::complex dt = system.imag_time_amplitude != 0.0 ? Type::complex(0.0, -p.dt) : Type::complex(p.dt, 0.0);
+    
+    std::vector<Type::complex> linear_dts = { dt * weights.front() / Type::real(2.0), dt * weights.front() };
+    for ( int k = 1; k < weights.size(); k++ )
+        linear_dts.push_back( dt * ( weights[k - 1] + weights[k] ) / Type::real(2.0) );
+
+    // A pending half step of a different timestep cannot be fused
+    if ( ssfm_half_step_pending and ( fft_propagator_dt.empty() or linear_dts.front() != fft_propagator_dt.front() ) )
+        flushPendingHalfStep();
+    // The fused step would apply the mask before the pending half step. In TE/TM mode, the propagator
+    // mixes the polarizations, so a polarization dependent mask does not commute with it.
+    if ( ssfm_half_step_pending and fft_mask_pending and fft_mask_polarized )
+        flushPendingHalfStep();
+
+    // This variable contains all the device pointers the kernel could need
+    auto device_pointers = matrix.pointers();
+
+    // Pointers to Oscillation Parameters
+    auto pulse_pointers = dev_pulse_oscillation.pointers();
+    auto pump_pointers = dev_pump_oscillation.pointers();
+    auto potential_pointers = dev_potential_oscillation.pointers();
+
+    updateFFTPropagator( block_size, grid_size, linear_dts );
+
+    // The linear kernels multiply the FFT mask into the linear step if the mask pointers are set.
+    // If the FFT Filter is due (-ssfmMask), the mask is applied in the leading linear step.
+    auto linear_pointers = device_pointers;
+    linear_pointers.fft_mask_plus = nullptr;
+    linear_pointers.fft_mask_minus = nullptr;
+    auto leading_linear_pointers = fft_mask_pending ? device_pointers : linear_pointers;
+    fft_mask_pending = false;
+    // Fuse the pending trailing half step of the last iteration with the leading half step
+    // by using the full step propagator. An unpolarized mask commutes with the propagator.
+    leading_linear_pointers.fft_propagator = getFFTPropagator( ssfm_half_step_pending ? 1 : 0 );
+    ssfm_half_step_pending = false;
+
+    // Linear Half (or Full) Step
     // Calculate the FFT of Psi
-    calculateFFT( device_pointers.k2_wavefunction_plus, device_pointers.k1_wavefunction_plus, FFT::forward );
+    calculateFFT( device_pointers.wavefunction_plus, device_pointers.k1_wavefunction_plus, FFT::forward );
     if (system.p.use_twin_mode)
-        calculateFFT( device_pointers.k2_wavefunction_minus, device_pointers.k1_wavefunction_minus, FFT::forward );
+        calculateFFT( device_pointers.wavefunction_minus, device_pointers.k1_wavefunction_minus, FFT::forward );
     CALL_KERNEL(
         RUNGE_FUNCTION_GP_LINEAR, "linear_half_step", grid_size, block_size, 
-        p.t, dt, device_pointers, p, pulse_pointers, pump_pointers, potential_pointers,
+        p.t, dt, leading_linear_pointers, p, pulse_pointers, pump_pointers, potential_pointers,
         { 
             device_pointers.k1_wavefunction_plus, device_pointers.k1_wavefunction_minus, device_pointers.discard, device_pointers.discard,
             device_pointers.k2_wavefunction_plus, device_pointers.k2_wavefunction_minus, device_pointers.discard, device_pointers.discard
         }
     );
-    // Transform back. K3 now holds the half-stepped wavefunction.
-    calculateFFT( device_pointers.k2_wavefunction_plus,  device_pointers.k1_wavefunction_plus, FFT::inverse );
-    if (system.p.use_twin_mode)
-        calculateFFT( device_pointers.k2_wavefunction_minus, device_pointers.k1_wavefunction_minus, FFT::inverse );
+    // Transform back. K1 now holds the half-stepped wavefunction.
+    calculateBatchedFFT( device_pointers.k2_wavefunction_plus, device_pointers.k1_wavefunction_plus, FFT::inverse );
 
-    CALL_KERNEL(
-        RUNGE_FUNCTION_GP_INDEPENDENT, "independent", grid_size, block_size, 
-        p.t, dt, device_pointers, p, pulse_pointers, pump_pointers, potential_pointers,
-        { 
-            device_pointers.k1_wavefunction_plus, device_pointers.k1_wavefunction_minus, device_pointers.reservoir_plus, device_pointers.reservoir_minus,
-            device_pointers.buffer_wavefunction_plus, device_pointers.buffer_wavefunction_minus, device_pointers.discard, device_pointers.discard
+    // The nonlinear step itself is only first order accurate. The higher order compositions
+    // require at least a second order nonlinear step, for which the exponential midpoint rule is used.
+    const bool midpoint = weights.size() > 1;
+
+    for ( int k = 0; k < weights.size(); k++ ) {
+        const Type::complex sub_dt = dt * weights[k];
+        // The reservoir alternates between the buffer and K1, starting from the current reservoir.
+        // Symmetric compositions have an odd number of sub-steps, so the buffer holds the final reservoir.
+        Type::complex* reservoir_plus = k == 0 ? device_pointers.reservoir_plus : ( k % 2 == 1 ? device_pointers.buffer_reservoir_plus : device_pointers.k1_reservoir_plus );
+        Type::complex* reservoir_minus = k == 0 ? device_pointers.reservoir_minus : ( k % 2 == 1 ? device_pointers.buffer_reservoir_minus : device_pointers.k1_reservoir_minus );
+        Type::complex* next_reservoir_plus = k % 2 == 0 ? device_pointers.buffer_reservoir_plus : device_pointers.k1_reservoir_plus;
+        Type::complex* next_reservoir_minus = k % 2 == 0 ? device_pointers.buffer_reservoir_minus : device_pointers.k1_reservoir_minus;
+
+        // Inner Linear Step
+        if ( k > 0 ) {
+            linear_pointers.fft_propagator = getFFTPropagator( 1 + k );
+            calculateBatchedFFT( device_pointers.k1_wavefunction_plus, device_pointers.k2_wavefunction_plus, FFT::forward );
+            CALL_KERNEL(
+                RUNGE_FUNCTION_GP_LINEAR, "linear_step", grid_size, block_size, 
+                p.t, sub_dt, linear_pointers, p, pulse_pointers, pump_pointers, potential_pointers,
+                { 
+                    device_pointers.k2_wavefunction_plus, device_pointers.k2_wavefunction_minus, device_pointers.discard, device_pointers.discard,
+                    device_pointers.k2_wavefunction_plus, device_pointers.k2_wavefunction_minus, device_pointers.discard, device_pointers.discard
+                }
+            );
+            calculateBatchedFFT( device_pointers.k2_wavefunction_plus, device_pointers.k1_wavefunction_plus, FFT::inverse );
         }
-    );
-    // Buffer now holds the new result
+
+        // Nonlinear Full Step. For the midpoint rule, the first kernel provides the midpoint state.
+        CALL_KERNEL(
+            RUNGE_FUNCTION_GP_NONLINEAR, "nonlinear_full_step", grid_size, block_size, 
+            p.t, midpoint ? sub_dt / Type::real(2.0) : sub_dt, device_pointers, p, pulse_pointers, pump_pointers, potential_pointers,
+            { 
+                device_pointers.k1_wavefunction_plus, device_pointers.k1_wavefunction_minus, reservoir_plus, reservoir_minus,
+                device_pointers.k2_wavefunction_plus, device_pointers.k2_wavefunction_minus, next_reservoir_plus, next_reservoir_minus
+            }
+        );
+        if ( midpoint )
+            CALL_KERNEL(
+                RUNGE_FUNCTION_GP_NONLINEAR_MIDPOINT, "nonlinear_midpoint_step", grid_size, block_size, 
+                p.t + p.dt * weights[k] / 2.0, sub_dt, device_pointers, p, pulse_pointers, pump_pointers, potential_pointers,
+                { 
+                    device_pointers.k1_wavefunction_plus, device_pointers.k1_wavefunction_minus, reservoir_plus, reservoir_minus,
+                    device_pointers.k2_wavefunction_plus, device_pointers.k2_wavefunction_minus, next_reservoir_plus, next_reservoir_minus
+                }
+            );
+        // K2 now holds the nonlinearly evolved wavefunction.
+
+        // The last independent part writes the new result into the buffer. The stochastic
+        // increment belongs to the full step and is only added there; it cannot be scaled
+        // by the composition weights, which may be negative.
+        const bool last = k == weights.size() - 1;
+        auto independent_p = p;
+        if ( not last )
+            independent_p.stochastic_amplitude = 0.0;
+        CALL_KERNEL(
+            RUNGE_FUNCTION_GP_INDEPENDENT, "independent", grid_size, block_size, 
+            p.t, sub_dt, device_pointers, independent_p, pulse_pointers, pump_pointers, potential_pointers,
+            { 
+                device_pointers.k2_wavefunction_plus, device_pointers.k2_wavefunction_minus, reservoir_plus, reservoir_minus,
+                last ? device_pointers.buffer_wavefunction_plus : device_pointers.k1_wavefunction_plus, last ? device_pointers.buffer_wavefunction_minus : device_pointers.k1_wavefunction_minus, 
+                device_pointers.discard, device_pointers.discard
+            }
+        );
+        p.t += p.dt * weights[k];
+    }
+    // Buffer now holds the new result, still missing the trailing linear half step
 
     // Swap the next and current wavefunction buffers. This only swaps the pointers, not the data.
     swapBuffers();
 
-}
\ No newline at end of file
+    // Defer the trailing linear half step. It is applied either fused with the next
+    // leading half step or by flushPendingHalfStep() when the wavefunction is evaluated.
+    ssfm_half_step_pending = true;
+    // The imaginary time propagation normalizes the wavefunction after each step, which requires the full step
+    if ( system.imag_time_amplitude != 0.0 )
+        flushPendingHalfStep();
+}
@@ -0,0 +1,165 @@
+#include "cuda/typedef.cuh"
+
+#include <omp.h>
+
+// Include Cuda Kernel headers
+#include "kernel/kernel_compute.cuh"
+#include "kernel/kernel_runge_kutta.cuh"
+#include "system/system_parameters.hpp"
+#include "misc/helperfunctions.hpp"
+#include "cuda/cuda_matrix.cuh"
+#include "solver/gpu_solver.hpp"
+#include "misc/commandline_io.hpp"
+
+/*
+* Adaptive Split Step Fourier Method using step doubling.
+* Each iteration performs one SSFM step with dt and two SSFM steps with dt/2
+* from the same initial state. The difference of both results estimates the
+* local error of the Strang splitting, which is of order dt^3.
+* ------------------------------------------------------------------------------
+* coarse = L(dt/2) I(dt) N(dt) L(dt/2) current                    -> K3
+* fine   = L(dt/4) I(dt/2) N(dt/2) L(dt/2) I(dt/2) N(dt/2) L(dt/4) current -> buffer
+* error  = |fine - coarse| / 3
+* ------------------------------------------------------------------------------
+* The two inner quarter steps of the fine solution are fused into a single half
+* step. All linear steps use the two cached propagators for dt/4 and dt/2.
+* The error is the Richardson estimate of the local error of the fine result in
+* the weighted RMS norm of the adaptive RK iterators, see RK::ErrorNorm. The
+* step is accepted and the next timestep is chosen by the StepSizeController
+* using the order of the Strang splitting. The timestep is always bounded by
+* dt_min and dt_max. The proposed timestep for the next iteration is stored in
+* proposed_dt.
+*/
+void PC3::Solver::iterateVariableTimestepSplitStepFourier( dim3 block_size, dim3 grid_size ) {
+    // Accept current step?
+    bool accept = false;
+
+    // This variable contains all the device pointers the kernel could need
+    auto device_pointers = matrix.pointers();
+
+    // Pointers to Oscillation Parameters
+    auto pulse_pointers = dev_pulse_oscillation.pointers();
+    auto pump_pointers = dev_pump_oscillation.pointers();
+    auto potential_pointers = dev_potential_oscillation.pointers();
+
+    // The partial sums only hold a few values per block, so they are summed on the host
+    const int n_partial = Kernel::RK::partial_sum_count( system.p.N_y, grid_size.x );
+    if ( rk_partial_sums.getTotalSize() != Kernel::RK::n_reduced * n_partial )
+        rk_partial_sums.construct( Kernel::RK::n_reduced * n_partial, 1, "RK Partial Sums" );
+
+    // The FFT mask is never applied within the adaptive linear steps
+    auto linear_pointers = device_pointers;
+    linear_pointers.fft_mask_plus = nullptr;
+    linear_pointers.fft_mask_minus = nullptr;
+
+    // Performs a single SSFM step from the io inputs to the io outputs. If trailing_propagator
+    // is nullptr, the trailing linear step is skipped, leaving it to the next step.
+    auto split_step = [&]( SystemParameters::KernelParameters& p, Type::complex dt, Type::complex* leading_propagator, Type::complex* trailing_propagator, Kernel::InputOutput io ) {
+        auto step_pointers = linear_pointers;
+        step_pointers.fft_propagator = leading_propagator;
+        calculateFFT( io.in_wf_plus, device_pointers.k1_wavefunction_plus, FFT::forward );
+        if ( system.p.use_twin_mode )
+            calculateFFT( io.in_wf_minus, device_pointers.k1_wavefunction_minus, FFT::forward );
+        CALL_KERNEL(
+            RUNGE_FUNCTION_GP_LINEAR, "linear_half_step", grid_size, block_size,
+            p.t, dt, step_pointers, p, pulse_pointers, pump_pointers, potential_pointers,
+            {
+                device_pointers.k1_wavefunction_plus, device_pointers.k1_wavefunction_minus, device_pointers.discard, device_pointers.discard,
+                device_pointers.k2_wavefunction_plus, device_pointers.k2_wavefunction_minus, device_pointers.discard, device_pointers.discard
+            }
+        );
+        calculateBatchedFFT( device_pointers.k2_wavefunction_plus, device_pointers.k1_wavefunction_plus, FFT::inverse );
+
+        CALL_KERNEL(
+            RUNGE_FUNCTION_GP_NONLINEAR, "nonlinear_full_step", grid_size, block_size,
+            p.t, dt, device_pointers, p, pulse_pointers, pump_pointers, potential_pointers,
+            {
+                device_pointers.k1_wavefunction_plus, device_pointers.k1_wavefunction_minus, io.in_rv_plus, io.in_rv_minus,
+                device_pointers.k2_wavefunction_plus, device_pointers.k2_wavefunction_minus, io.out_rv_plus, io.out_rv_minus
+            }
+        );
+
+        // Without trailing linear step, the independent part writes directly to the outputs
+        Type::complex* independent_plus = trailing_propagator == nullptr ? io.out_wf_plus : device_pointers.k1_wavefunction_plus;
+        Type::complex* independent_minus = trailing_propagator == nullptr ? io.out_wf_minus : device_pointers.k1_wavefunction_minus;
+        CALL_KERNEL(
+            RUNGE_FUNCTION_GP_INDEPENDENT, "independent", grid_size, block_size,
+            p.t, dt, device_pointers, p, pulse_pointers, pump_pointers, potential_pointers,
+            {
+                device_pointers.k2_wavefunction_plus, device_pointers.k2_wavefunction_minus, io.out_rv_plus, io.out_rv_minus,
+                independent_plus, independent_minus, device_pointers.discard, device_pointers.discard
+            }
+        );
+        if ( trailing_propagator == nullptr )
+            return;
+
+        step_pointers.fft_propagator = trailing_propagator;
+        calculateBatchedFFT( device_pointers.k1_wavefunction_plus, device_pointers.k2_wavefunction_plus, FFT::forward );
+        CALL_KERNEL(
+            RUNGE_FUNCTION_GP_LINEAR, "linear_half_step", grid_size, block_size,
+            p.t, dt, step_pointers, p, pulse_pointers, pump_pointers, potential_pointers,
+            {
+                device_pointers.k2_wavefunction_plus, device_pointers.k2_wavefunction_minus, device_pointers.discard, device_pointers.discard,
+                device_pointers.k1_wavefunction_plus, device_pointers.k1_wavefunction_minus, device_pointers.discard, device_pointers.discard
+            }
+        );
+        calculateFFT( device_pointers.k1_wavefunction_plus, io.out_wf_plus, FFT::inverse );
+        if ( system.p.use_twin_mode )
+            calculateFFT( device_pointers.k1_wavefunction_minus, io.out_wf_minus, FFT::inverse );
+    };
+
+    do {
+        // We snapshot here to make sure that the dt is updated
+        auto p = system.kernel_parameters;
+        Type::complex dt = system.imag_time_amplitude != 0.0 ? Type::complex(0.0, -p.dt) : Type::complex(p.dt, 0.0);
+        Type::complex half_dt = dt / Type::real(2.0);
+
+        // Cache the propagators for the linear steps dt/4 and dt/2
+        updateFFTPropagator( block_size, grid_size, { dt / Type::real(4.0), half_dt } );
+        Type::complex* quarter_propagator = getFFTPropagator( 0 );
+        Type::complex* half_propagator = getFFTPropagator( 1 );
+
+        // Coarse step with dt. K3 holds the coarse result.
+        split_step( p, dt, half_propagator, half_propagator, {
+            device_pointers.wavefunction_plus, device_pointers.wavefunction_minus, device_pointers.reservoir_plus, device_pointers.reservoir_minus,
+            device_pointers.k3_wavefunction_plus, device_pointers.k3_wavefunction_minus, device_pointers.k3_reservoir_plus, device_pointers.k3_reservoir_minus
+        } );
+
+        // Two fine steps with dt/2. The buffer holds the fine result.
+        split_step( p, half_dt, quarter_propagator, nullptr, {
+            device_pointers.wavefunction_plus, device_pointers.wavefunction_minus, device_pointers.reservoir_plus, device_pointers.reservoir_minus,
+            device_pointers.buffer_wavefunction_plus, device_pointers.buffer_wavefunction_minus, device_pointers.buffer_reservoir_plus, device_pointers.buffer_reservoir_minus
+        } );
+        p.t += p.dt / 2.0;
+        split_step( p, half_dt, half_propagator, quarter_propagator, {
+            device_pointers.buffer_wavefunction_plus, device_pointers.buffer_wavefunction_minus, device_pointers.buffer_reservoir_plus, device_pointers.buffer_reservoir_minus,
+            device_pointers.buffer_wavefunction_plus, device_pointers.buffer_wavefunction_minus, device_pointers.buffer_reservoir_plus, device_pointers.buffer_reservoir_minus
+        } );
+
+        // Reduce the scaled squared differences between the fine and the coarse result and sum the partial sums.
+        // The device pointer has to be requested for every attempt, otherwise the host vector is not synchronized.
+        Kernel::RK::ErrorNorm norm = { rk_partial_sums.getDevicePtr(), system.absolute_tolerance, system.relative_tolerance, system.error_norm_reservoir };
+        CALL_KERNEL(
+            Kernel::RK::step_doubling_error, "Step Doubling Error", grid_size, block_size,
+            device_pointers, p, norm
+        );
+        const auto& partial_sums = rk_partial_sums.getHostVector();
+        Type::real error_sum = 0.0;
+        for ( int b = 0; b < n_partial; b++ )
+            error_sum += partial_sums[Kernel::RK::error_sum * n_partial + b];
+        const int n_values = p.N2 * ( p.use_twin_mode ? 2 : 1 ) * ( system.error_norm_reservoir ? 2 : 1 );
+        // Richardson estimate of the local error of the fine result
+        const Type::real final_error = std::sqrt( error_sum / n_values ) / Type::real( 3.0 );
+
+        Type::real next_dt;
+        accept = system.step_size_controller.update( final_error, p.dt, 2, system.dt_min, system.dt_max, next_dt );
+        if ( accept ) {
+            proposed_dt = next_dt;
+            // Swap the next and current wavefunction buffers. This only swaps the pointers, not the data.
+            swapBuffers();
+        } else {
+            // Retry with the smaller timestep
+            system.p.dt = next_dt;
+        }
+    } while ( !accept );
+}
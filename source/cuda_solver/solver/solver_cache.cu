@@ -6,6 +6,10 @@
 #include "solver/gpu_solver.hpp"
 
 void PC3::Solver::cacheValues() {
+    // Apply a deferred SSFM half step and FFT Filter before evaluating the wavefunction
+    flushPendingHalfStep();
+    flushPendingFFTFilter();
+
     // System Time
     cache_map_scalar["t"].emplace_back( system.p.t );
     //matrix.times.emplace_back( system.p.t );
@@ -41,6 +45,13 @@ void PC3::Solver::cacheValues() {
         cache_map_scalar["potential_"+std::to_string(g)].push_back( PC3::CUDA::real(potential) );
     }
 
+    // Timestep history and step statistics of the adaptive RK iterators
+    if ( system.step_size_controller.isUsed() ) {
+        cache_map_scalar["dt"].emplace_back( system.step_size_controller.last_dt );
+        cache_map_scalar["accepted_steps"].emplace_back( system.step_size_controller.accepted_steps );
+        cache_map_scalar["rejected_steps"].emplace_back( system.step_size_controller.rejected_steps );
+    }
+
     // TE/TM Guard
     if ( not system.p.use_twin_mode )
         return;
@@ -109,6 +120,8 @@ size_t _local_file_out_counter = 0;
 void PC3::Solver::cacheMatrices() {
     if (not system.do_output_history_matrix)
         return;
+    flushPendingHalfStep();
+    flushPendingFFTFilter();
     std::string suffix = "_"+std::to_string(_local_file_out_counter);
     _local_file_out_counter++;
     outputMatrices( system.history_matrix_start_x, system.history_matrix_end_x, system.history_matrix_start_y, system.history_matrix_end_y, system.history_matrix_output_increment, suffix, "timeoutput/" );
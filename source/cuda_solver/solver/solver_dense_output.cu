@@ -0,0 +1,36 @@
+#include "cuda/typedef.cuh"
+#include "solver/gpu_solver.hpp"
+
+/*
+ * The dense output requires the state and the Ks of the last step to be unchanged after the step.
+ * The stochastic contribution, the normalization of the imaginary time propagation and the FFT
+ * filter all modify the state or the right hand side outside of the Runge-Kutta stages, so these
+ * fall back to shortening the timestep. With live rendering, the timestep is never adjusted.
+ * The multi-rate mode does not store the reservoir Ks, which the interpolation requires.
+ */
+bool PC3::Solver::useDenseOutput() {
+    return system.dense_output and system.disableRender and iterator[system.iterator].dense_output and not system.evaluateStochastic() and system.imag_time_amplitude == 0.0 and system.fft_mask.size() == 0 and not system.p.multi_rate;
+}
+
+void PC3::Solver::beginDenseOutput( Type::real t ) {
+    // The output time has to be within the last step. Otherwise, the current state is used.
+    if ( not useDenseOutput() or dense_output_dt <= 0.0 or t <= dense_output_t0 or t >= system.p.t )
+        return;
+
+    dim3 block_size( system.block_size, 1 );
+    dim3 grid_size( ( system.p.N_x * system.p.N_y + block_size.x ) / block_size.x, 1 );
+    iterator[system.iterator].dense_output( block_size, grid_size, t );
+
+    // Swap the interpolated state into the wavefunction and reservoir matrices. This only swaps the pointers, not the data.
+    swapDenseOutput();
+    dense_output_t1 = system.p.t;
+    system.p.t = t;
+}
+
+void PC3::Solver::endDenseOutput() {
+    if ( dense_output_t1 < 0.0 )
+        return;
+    swapDenseOutput();
+    system.p.t = dense_output_t1;
+    dense_output_t1 = -1.0;
+}
@@ -6,10 +6,20 @@
 
 #ifdef USE_CPU
 
+    #include <map>
+    #include <tuple>
     #include <fftw3.h>
+    #ifdef USE_HALF_PRECISION
+        #define FFTW(name) fftwf_##name
+        using fft_type = fftwf_complex;
+    #else
+        #define FFTW(name) fftw_##name
+        using fft_type = fftw_complex;
+    #endif
 
 #else
 
+    #include <map>
     #include <cufft.h>
     #include <curand_kernel.h>
     #define cuda_fft_plan cufftHandle
@@ -29,121 +39,235 @@
 #ifdef USE_CUDA
     /**
      * Static Helper Function to get the cuFFT Plan. The static variables ensure the
-     * fft plan is only created once. We don't destroy the plan and hope the operating
-     * system will forgive us. We could also implement a small wrapper class that
-     * holds the plan and calls the destruct method when the class instance is destroyed.
+     * fft plan is only created once per batch size. We don't destroy the plans and hope
+     * the operating system will forgive us. We could also implement a small wrapper class
+     * that holds the plan and calls the destruct method when the class instance is destroyed.
+     * Batched plans transform [batch] contiguous grids of size N_x*N_y.
     */
-    static cufftHandle& getFFTPlan( size_t N_x, size_t N_y ) {
-        static cufftHandle plan = 0;
-        static bool isInitialized = false;
+    static cufftHandle& getFFTPlan( size_t N_x, size_t N_y, int batch = 1 ) {
+        static std::map<int, cufftHandle> plans;
+
+        if ( auto it = plans.find( batch ); it != plans.end() )
+            return it->second;
+
+        cufftHandle& plan = plans[batch];
+        int n[2] = { (int)N_x, (int)N_y };
+        const int dist = N_x * N_y;
+        if ( cufftPlanMany( &plan, 2, n, nullptr, 1, dist, nullptr, 1, dist, FFTPLAN, batch ) != CUFFT_SUCCESS ) {
+            std::cout << PC3::CLIO::prettyPrint( "Error Creating CUDA FFT Plan!", PC3::CLIO::Control::FullError ) << std::endl;
+        }
+
+        return plan;
+    }
 
-        if (not isInitialized) {
-            if ( cufftPlan2d( &plan, N_x, N_y, FFTPLAN ) != CUFFT_SUCCESS ) {
-                std::cout << PC3::CLIO::prettyPrint( "Error Creating CUDA FFT Plan!", PC3::CLIO::Control::FullError ) << std::endl;
+#else
+    /**
+     * FFTW requires fftw_init_threads before any other FFTW call, including the wisdom import.
+     * The threads are initialized once and cleaned up at program exit. The guard is always
+     * constructed before the plan cache, so it is destroyed after the plans.
+    */
+    static void initializeFFTWThreads() {
+        struct ThreadGuard {
+            ThreadGuard() {
+                FFTW( init_threads )();
+            }
+            ~ThreadGuard() {
+                FFTW( cleanup_threads )();
+            }
+        };
+        static ThreadGuard guard;
+    }
+
+    /**
+     * Static Helper Function to get a cached FFTW Plan. Plans are created once per
+     * grid size, batch size, direction, in-place/out-of-place transform, alignment and
+     * precision and are then reused for arbitrary arrays using the new-array execute functions.
+     * The plans are created on scratch arrays, such that no actual data is touched by
+     * the planner, which allows for planner flags that overwrite their input arrays.
+     * All plans use the same number of threads as the OpenMP kernels.
+     * The cache destroys the plans when it goes out of scope at program exit.
+    */
+    class FFTPlanCache {
+       public:
+        // N_x, N_y, batch, direction, in-place, aligned, precision
+        using Key = std::tuple<size_t, size_t, int, int, bool, bool, size_t>;
+
+        ~FFTPlanCache() {
+            for ( auto& [key, plan] : plans )
+                FFTW( destroy_plan )( plan );
+        }
+
+        FFTW( plan ) get( size_t N_x, size_t N_y, int batch, int direction, bool in_place, bool aligned, int threads, unsigned planner_flags ) {
+            const Key key{ N_x, N_y, batch, direction, in_place, aligned, sizeof( PC3::Type::real ) };
+            if ( auto it = plans.find( key ); it != plans.end() )
+                return it->second;
+
+            FFTW( plan_with_nthreads )( threads );
+
+            // Scratch arrays from fftw_malloc are always SIMD aligned. Unaligned input
+            // arrays (e.g. from std::vector) require a plan without alignment assumptions.
+            const int dist = N_x * N_y;
+            const size_t N = dist * batch;
+            fft_type* scratch_in = reinterpret_cast<fft_type*>( FFTW( malloc )( sizeof( fft_type ) * N ) );
+            fft_type* scratch_out = in_place ? scratch_in : reinterpret_cast<fft_type*>( FFTW( malloc )( sizeof( fft_type ) * N ) );
+            const unsigned flags = planner_flags | ( aligned ? 0u : FFTW_UNALIGNED );
+            const int n[2] = { (int)N_x, (int)N_y };
+            auto plan = FFTW( plan_many_dft )( 2, n, batch, scratch_in, nullptr, 1, dist, scratch_out, nullptr, 1, dist, direction, flags );
+            FFTW( free )( scratch_in );
+            if ( not in_place )
+                FFTW( free )( scratch_out );
+
+            if ( plan == nullptr ) {
+                std::cout << PC3::CLIO::prettyPrint( "Error Creating FFTW Plan!", PC3::CLIO::Control::FullError ) << std::endl;
                 return plan;
             }
-            isInitialized = true;
+            plans[key] = plan;
+            return plan;
         }
 
-        return plan;
+       private:
+        std::map<Key, FFTW( plan )> plans;
+    };
+
+    static FFTW( plan ) getFFTPlan( size_t N_x, size_t N_y, int batch, fft_type* in, fft_type* out, int direction, int threads, unsigned planner_flags ) {
+        initializeFFTWThreads();
+        static FFTPlanCache cache;
+        const bool aligned = FFTW( alignment_of )( reinterpret_cast<PC3::Type::real*>( in ) ) == 0 and FFTW( alignment_of )( reinterpret_cast<PC3::Type::real*>( out ) ) == 0;
+        return cache.get( N_x, N_y, batch, direction, in == out, aligned, threads, planner_flags );
+    }
+
+    // Translates the --fftPlanner input into the FFTW planner flag
+    static unsigned getFFTPlannerFlag( const std::string& planner ) {
+        if ( planner == "measure" )
+            return FFTW_MEASURE;
+        if ( planner == "patient" )
+            return FFTW_PATIENT;
+        if ( planner == "exhaustive" )
+            return FFTW_EXHAUSTIVE;
+        return FFTW_ESTIMATE;
     }
 
 #endif
 
 /*
  * This function calculates the Fast Fourier Transformation of Psi+ and Psi-
- * and saves the result in dev_fft_plus and dev_fft_minus. These values can
- * then be grabbed using the getDeviceArrays() function. The FFT is then
- * shifted such that k = 0 is in the center of the FFT matrix. Then, the
- * FFT Filter is applied to the FFT, and the FFT is shifted back. Finally,
- * the inverse FFT is calculated and the result is saved in dev_current_Psi_Plus
- * and dev_current_Psi_Minus. The FFT Arrays are shifted once again for
- * visualization purposes.
- * NOTE/OPTIMIZATION: The Shift->Filter->Shift function will be changed later
- * to a cached filter mask, which itself will be shifted.
+ * and saves the result in dev_fft_plus and dev_fft_minus. The FFT Filter is
+ * then applied to the unshifted FFT using the pre-shifted mask, which also
+ * contains the 1/N normalization of the inverse FFT. Finally, the inverse FFT
+ * is calculated and the result is saved in dev_current_Psi_Plus and
+ * dev_current_Psi_Minus. The FFT Arrays are kept unshifted; shifting k = 0 to
+ * the center for visualization is done when the FFT is output or plotted.
  */
-void PC3::Solver::applyFFTFilter( dim3 block_size, dim3 grid_size, bool apply_mask ) {
-    
-    // Calculate the actual FFTs
-    calculateFFT( matrix.wavefunction_plus.getDevicePtr(), matrix.fft_plus.getDevicePtr(), FFT::forward );
+void PC3::Solver::applyFFTFilter( dim3 block_size, dim3 grid_size ) {
+    // The filter acts on the synchronized wavefunction
+    flushPendingHalfStep();
+    // The filter changes the state, so a cached first RK stage is invalid
+    rk_first_stage_cached = false;
 
-    // For now, we shift, transform, shift the results. TODO: Move this into one function without shifting
-    // Shift FFT to center k = 0
-    CALL_KERNEL( PC3::Kernel::fft_shift_2D, "FFT Shift Plus", grid_size, block_size, 
-        matrix.fft_plus.getDevicePtr(), system.p.N_x, system.p.N_y 
-    );
+    // The minus components live in the second half of the stacked plus matrices
+    Type::complex* fft_minus = matrix.fft_plus.getDevicePtr() + system.p.N2;
+    Type::real* fft_mask_minus = matrix.fft_mask_plus.getDevicePtr() + system.p.N2;
+
+    // Calculate the actual FFT
+    calculateFFT( matrix.wavefunction_plus.getDevicePtr(), matrix.fft_plus.getDevicePtr(), FFT::forward );
 
-    // Do the FFT and the shifting here already for visualization only
-    if ( system.p.use_twin_mode ) {
-        calculateFFT( matrix.wavefunction_minus.getDevicePtr(), matrix.fft_minus.getDevicePtr(), FFT::forward );
-        
-        CALL_KERNEL( PC3::Kernel::fft_shift_2D, "FFT Shift Minus", grid_size, block_size, 
-            matrix.fft_minus.getDevicePtr(), system.p.N_x, system.p.N_y 
-        );
-    }
-    
-    if (not apply_mask)
-        return;
-    
     // Apply the FFT Mask Filter
-    CALL_KERNEL(PC3::Kernel::kernel_mask_fft, "FFT Mask Plus", grid_size, block_size, 
-        matrix.fft_plus.getDevicePtr(), matrix.fft_mask_plus.getDevicePtr(), system.p.N_x*system.p.N_y
-    );
-    
-    // Undo the shift
-    CALL_KERNEL( PC3::Kernel::fft_shift_2D, "FFT Shift Plus", grid_size, block_size, 
-         matrix.fft_plus.getDevicePtr(), system.p.N_x, system.p.N_y 
+    CALL_KERNEL( PC3::Kernel::kernel_mask_fft, "FFT Mask Plus", grid_size, block_size, 
+        matrix.fft_plus.getDevicePtr(), matrix.fft_mask_plus.getDevicePtr(), system.p.N2
     );
 
     // Transform back.
-    calculateFFT(  matrix.fft_plus.getDevicePtr(), matrix.wavefunction_plus.getDevicePtr(), FFT::inverse );
-    
-    // Shift FFT Once again for visualization
-    CALL_KERNEL( PC3::Kernel::fft_shift_2D, "FFT Shift Plus", grid_size, block_size, 
-        matrix.fft_plus.getDevicePtr(), system.p.N_x, system.p.N_y 
-    );
+    calculateFFT( matrix.fft_plus.getDevicePtr(), matrix.wavefunction_plus.getDevicePtr(), FFT::inverse );
     
     // Do the same for the minus component
     if (not system.p.use_twin_mode)
         return;
 
-    CALL_KERNEL(PC3::Kernel::kernel_mask_fft, "FFT Mask Plus", grid_size, block_size, 
-        matrix.fft_minus.getDevicePtr(), matrix.fft_mask_minus.getDevicePtr(), system.p.N_x*system.p.N_y 
-    );
+    calculateFFT( matrix.wavefunction_minus.getDevicePtr(), fft_minus, FFT::forward );
 
-    CALL_KERNEL( PC3::Kernel::fft_shift_2D, "FFT Minus Plus", grid_size, block_size, 
-        matrix.fft_minus.getDevicePtr(), system.p.N_x,system.p.N_y 
+    CALL_KERNEL( PC3::Kernel::kernel_mask_fft, "FFT Mask Minus", grid_size, block_size, 
+        fft_minus, fft_mask_minus, system.p.N2 
     );
     
-    calculateFFT( matrix.fft_minus.getDevicePtr(), matrix.wavefunction_minus.getDevicePtr(), FFT::inverse );
+    calculateFFT( fft_minus, matrix.wavefunction_minus.getDevicePtr(), FFT::inverse );
+}
 
-    CALL_KERNEL( PC3::Kernel::fft_shift_2D, "FFT Minus Plus", grid_size, block_size, 
-        matrix.fft_minus.getDevicePtr(), system.p.N_x,system.p.N_y 
-    );
+/*
+ * With -ssfmMask, a due FFT Filter is deferred into the next SSFM linear half step,
+ * which already transforms the wavefunction into k-space. Before the wavefunction is
+ * cached, output or plotted, a still pending filter is applied here instead such that
+ * the results are identical to applying the filter separately.
+ */
+void PC3::Solver::flushPendingFFTFilter() {
+    if ( not fft_mask_pending )
+        return;
+    dim3 block_size( system.block_size, 1 );
+    dim3 grid_size( ( system.p.N_x*system.p.N_y + block_size.x ) / block_size.x, 1 );
+    applyFFTFilter( block_size, grid_size );
+    fft_mask_pending = false;
+}
 
+/*
+ * Calculates the FFT of Psi+ and Psi- for visualization only. If no FFT mask
+ * is applied, the FFT is not needed during the iteration and is instead calculated
+ * lazily using this function when the FFT is output or plotted.
+ */
+void PC3::Solver::calculateVisualizationFFT() {
+    calculateFFT( matrix.wavefunction_plus.getDevicePtr(), matrix.fft_plus.getDevicePtr(), FFT::forward );
+    if ( system.p.use_twin_mode )
+        calculateFFT( matrix.wavefunction_minus.getDevicePtr(), matrix.fft_plus.getDevicePtr() + system.p.N2, FFT::forward );
 }
 
 void PC3::Solver::calculateFFT( Type::complex* device_ptr_in, Type::complex* device_ptr_out, FFT dir ) {
+    calculateFFT( device_ptr_in, device_ptr_out, dir, 1 );
+}
+
+/**
+ * Transforms all components of a stacked matrix (see matrix_container.hpp) using a single
+ * batched FFT. In TE/TM mode, this transforms both the plus and the minus components,
+ * in the scalar mode this is equivalent to calculateFFT.
+ */
+void PC3::Solver::calculateBatchedFFT( Type::complex* device_ptr_in, Type::complex* device_ptr_out, FFT dir ) {
+    calculateFFT( device_ptr_in, device_ptr_out, dir, matrix.twin_stack );
+}
+
+void PC3::Solver::calculateFFT( Type::complex* device_ptr_in, Type::complex* device_ptr_out, FFT dir, int batch ) {
     #ifdef USE_CUDA
         // Do FFT using CUDAs FFT functions
-        auto plan = getFFTPlan( system.p.N_x, system.p.N_y );
+        auto plan = getFFTPlan( system.p.N_x, system.p.N_y, batch );
         CHECK_CUDA_ERROR( FFTSOLVER( plan, reinterpret_cast<fft_type*>(device_ptr_in), reinterpret_cast<fft_type*>(device_ptr_out), dir == FFT::inverse ? CUFFT_INVERSE : CUFFT_FORWARD ), "FFT Exec" );
-    #else   
-        //auto [plan_forward, plan_inverse] = getFFTPlan(system.p.N_x, system.p.N_y, device_ptr_in, device_ptr_out);
-        #ifdef USE_HALF_PRECISION
-        auto plan = fftwf_plan_dft_2d(system.p.N_x, system.p.N_y,
-                                      reinterpret_cast<fftwf_complex*>(device_ptr_in),
-                                      reinterpret_cast<fftwf_complex*>(device_ptr_out),
-                                      dir == FFT::inverse ? FFTW_BACKWARD : FFTW_FORWARD, FFTW_ESTIMATE);        
-        fftwf_execute(plan);
-        fftwf_destroy_plan(plan);
-        #else
-        auto plan = fftw_plan_dft_2d(system.p.N_x, system.p.N_y,
-                                      reinterpret_cast<fftw_complex*>(device_ptr_in),
-                                      reinterpret_cast<fftw_complex*>(device_ptr_out),
-                                      dir == FFT::inverse ? FFTW_BACKWARD : FFTW_FORWARD, FFTW_ESTIMATE);        
-        fftw_execute(plan);
-        fftw_destroy_plan(plan);
-        #endif
+    #else
+        auto in = reinterpret_cast<fft_type*>( device_ptr_in );
+        auto out = reinterpret_cast<fft_type*>( device_ptr_out );
+        auto plan = getFFTPlan( system.p.N_x, system.p.N_y, batch, in, out, dir == FFT::inverse ? FFTW_BACKWARD : FFTW_FORWARD, system.omp_max_threads, getFFTPlannerFlag( system.fft_planner ) );
+        FFTW( execute_dft )( plan, in, out );
     #endif
-}
\ No newline at end of file
+}
+
+/**
+ * FFTW Wisdom contains the results of previous (measured) planning runs. Importing
+ * it before the first plan is created makes measured plans available at the cost
+ * of estimated plans. cuFFT does not support wisdom, so these functions only affect
+ * the CPU version.
+ */
+void PC3::Solver::importFFTWisdom() {
+    #ifdef USE_CPU
+        if ( system.fft_wisdom_file.empty() )
+            return;
+        initializeFFTWThreads();
+        if ( FFTW( import_wisdom_from_filename )( system.fft_wisdom_file.c_str() ) )
+            std::cout << PC3::CLIO::prettyPrint( "Imported FFTW wisdom from '" + system.fft_wisdom_file + "'", PC3::CLIO::Control::Info ) << std::endl;
+        else
+            std::cout << PC3::CLIO::prettyPrint( "Could not import FFTW wisdom from '" + system.fft_wisdom_file + "'. Plans will be created from scratch.", PC3::CLIO::Control::Secondary | PC3::CLIO::Control::Warning ) << std::endl;
+    #endif
+}
+
+void PC3::Solver::exportFFTWisdom() {
+    #ifdef USE_CPU
+        if ( system.fft_wisdom_file.empty() )
+            return;
+        initializeFFTWThreads();
+        if ( not FFTW( export_wisdom_to_filename )( system.fft_wisdom_file.c_str() ) )
+            std::cout << PC3::CLIO::prettyPrint( "Could not export FFTW wisdom to '" + system.fft_wisdom_file + "'", PC3::CLIO::Control::Warning ) << std::endl;
+    #endif
+}
@@ -3,9 +3,16 @@
 #include "misc/commandline_io.hpp"
 
 void PC3::Solver::finalize() {
+    // Wait for the noise generated in the background
+    awaitNoise();
+    // Apply a deferred SSFM half step and FFT Filter
+    flushPendingHalfStep();
+    flushPendingFFTFilter();
     // Output Matrices
     outputMatrices( 0 /*start*/, system.p.N_x /*end*/, 0 /*start*/, system.p.N_y /*end*/, 1.0 /*increment*/);
     // Cache to files
     std::cout << PC3::CLIO::prettyPrint( "Caching to Files... ", PC3::CLIO::Control::Info ) << std::endl;
     cacheToFiles();
+    // Save FFT wisdom for the next run
+    exportFFTWisdom();
 }
\ No newline at end of file
@@ -17,11 +17,38 @@ void PC3::Solver::initializeHostMatricesFromSystem() {
         std::cout << PC3::CLIO::prettyPrint( "Selected iterator not available. Falling back to RK4.", PC3::CLIO::Control::Secondary | PC3::CLIO::Control::Warning ) << std::endl;
         system.iterator = "rk4";
     }
+    // The multi-rate mode is only supported by the Runge-Kutta tableau iterators and does not provide reservoir errors
+    if ( system.p.multi_rate and not iterator[system.iterator].multi_rate ) {
+        std::cout << PC3::CLIO::prettyPrint( "The '" + system.iterator + "' iterator does not support -multiRate. Integrating the reservoir using the iterator instead.", PC3::CLIO::Control::Secondary | PC3::CLIO::Control::Warning ) << std::endl;
+        system.p.multi_rate = false;
+    }
+    // The wavefront sweep is only implemented for the fixed timestep Runge-Kutta tableau iterators on the CPU
+#ifdef USE_CUDA
+    if ( system.wavefront ) {
+        std::cout << PC3::CLIO::prettyPrint( "--wavefront is only available on the CPU.", PC3::CLIO::Control::Secondary | PC3::CLIO::Control::Warning ) << std::endl;
+        system.wavefront = false;
+    }
+#endif
+    if ( system.wavefront and not iterator[system.iterator].wavefront ) {
+        std::cout << PC3::CLIO::prettyPrint( "The '" + system.iterator + "' iterator does not support --wavefront. Using full grid passes instead.", PC3::CLIO::Control::Secondary | PC3::CLIO::Control::Warning ) << std::endl;
+        system.wavefront = false;
+    }
+    if ( system.wavefront and system.p.periodic_boundary_y )
+        std::cout << PC3::CLIO::prettyPrint( "--wavefront requires zero boundaries in y to split the grid into bands. The wavefront sweep only fuses timesteps.", PC3::CLIO::Control::Secondary | PC3::CLIO::Control::Warning ) << std::endl;
+    // The halo is only filled by the Runge-Kutta tableau iterators
+    if ( system.p.halo_padding and not iterator[system.iterator].halo_padding ) {
+        std::cout << PC3::CLIO::prettyPrint( "The '" + system.iterator + "' iterator does not support -haloPadding. Using unpadded matrices instead.", PC3::CLIO::Control::Secondary | PC3::CLIO::Control::Warning ) << std::endl;
+        system.p.halo_padding = false;
+    }
+    if ( system.p.multi_rate and system.error_norm_reservoir ) {
+        std::cout << PC3::CLIO::prettyPrint( "-errorReservoir has no effect with -multiRate, because the reservoir is advanced exactly.", PC3::CLIO::Control::Secondary | PC3::CLIO::Control::Warning ) << std::endl;
+        system.error_norm_reservoir = false;
+    }
 
     // First, construct all required host matrices
     bool use_fft = system.fft_every < system.t_max;
     bool use_stochastic = system.p.stochastic_amplitude > 0.0;
-    matrix.constructAll( system.p.N_x, system.p.N_y, system.p.use_twin_mode, use_fft, use_stochastic, iterator[system.iterator].k_max , system.pulse.groupSize(), system.pump.groupSize(), system.potential.groupSize() );
+    matrix.constructAll( system.p.N_x, system.p.N_y, system.p.use_twin_mode, use_fft, use_stochastic, useDenseOutput(), system.p.multi_rate, system.p.halo_padding ? 2 * system.p.N_x : 0, iterator[system.iterator].n_fft_propagators, iterator[system.iterator].k_max, system.pulse.groupSize(), system.pump.groupSize(), system.potential.groupSize() );
 
     // ==================================================
     // =................ Initial States ................=
@@ -92,10 +119,11 @@ void PC3::Solver::initializeHostMatricesFromSystem() {
     std::cout << PC3::CLIO::prettyPrint( "Initializing FFT Envelopes...", PC3::CLIO::Control::Info ) << std::endl;
     if ( system.fft_mask.size() == 0 ) {
         std::cout << PC3::CLIO::prettyPrint( "No fft mask provided.", PC3::CLIO::Control::Secondary | PC3::CLIO::Control::Warning ) << std::endl;
-    } else {
+    } else if ( matrix.use_fft ) {
         system.fft_mask.calculate( system.filehandler, matrix.fft_mask_plus.getHostPtr(), PC3::Envelope::AllGroups, PC3::Envelope::Polarization::Plus, dim, 1.0 /* Default if no mask is applied */ );
         if ( system.p.use_twin_mode ) {
-            system.fft_mask.calculate( system.filehandler, matrix.fft_mask_minus.getHostPtr(), PC3::Envelope::AllGroups, PC3::Envelope::Polarization::Minus, dim, 1.0 /* Default if no mask is applied */ );
+            system.fft_mask.calculate( system.filehandler, matrix.fft_mask_plus.getHostPtr() + system.p.N2, PC3::Envelope::AllGroups, PC3::Envelope::Polarization::Minus, dim, 1.0 /* Default if no mask is applied */ );
+            fft_mask_polarized = not std::equal( matrix.fft_mask_plus.getHostPtr(), matrix.fft_mask_plus.getHostPtr() + system.p.N2, matrix.fft_mask_plus.getHostPtr() + system.p.N2 );
         }
     }
 
@@ -117,6 +145,18 @@ void PC3::Solver::initializeDeviceMatricesFromHost() {
     matrix.wavefunction_plus.setTo( matrix.initial_state_plus );
     matrix.reservoir_plus.setTo( matrix.initial_reservoir_plus );
 
+    // Pre-shift the FFT mask such that it can be applied to the unshifted FFT directly and
+    // fold the 1/N normalization of the inverse FFT into it. The mask was already output
+    // unshifted by outputInitialMatrices().
+    if ( system.fft_mask.size() > 0 and matrix.use_fft ) {
+        for ( int c = 0; c < matrix.twin_stack; c++ ) {
+            Type::real* mask = matrix.fft_mask_plus.getHostPtr() + c * system.p.N2;
+            const Type::host_vector<Type::real> unshifted( mask, mask + system.p.N2 );
+            for ( int i = 0; i < system.p.N2; i++ )
+                mask[i] = unshifted[PC3::Kernel::ifft_shift_index( i, system.p.N_x, system.p.N_y )] / Type::real( system.p.N2 );
+        }
+    }
+
     // TE/TM Guard
     if ( not system.p.use_twin_mode )
         return;
@@ -0,0 +1,63 @@
+#include "cuda/typedef.cuh"
+#include "solver/gpu_solver.hpp"
+#include "kernel/kernel_compute.cuh"
+
+/*
+ * The noise of an iteration only depends on the seed, the iteration and the grid index, see
+ * kernel/kernel_random_numbers.cuh. The noise of the next iteration can therefore be generated
+ * while the current iteration runs, without changing the result. The noise buffers hold the
+ * normal random numbers scaled by the stochastic amplitude; the timestep is applied by the kernels.
+ */
+
+void PC3::Solver::generateNoise( Type::complex* buffer, unsigned int iteration ) {
+    dim3 block_size( system.block_size, 1 );
+    dim3 grid_size( ( system.p.N_x * system.p.N_y + block_size.x ) / block_size.x, 1 );
+    CALL_KERNEL(
+        PC3::Kernel::generate_random_numbers, "random_number_gen", grid_size, block_size,
+        buffer, system.p.N_x * system.p.N_y, system.random_seed, iteration, system.p.stochastic_amplitude, system.p.stochastic_amplitude
+    );
+}
+
+void PC3::Solver::prefetchNoise( unsigned int iteration ) {
+    awaitNoise();
+    noise_prefetched_iteration = iteration;
+    Type::complex* buffer = matrix.random_number_next.getDevicePtr();
+    const unsigned int N = system.p.N_x * system.p.N_y;
+#ifdef USE_CPU
+    // The kernels of the previous iteration have finished, so the buffer is free. The noise is generated by a separate thread team.
+    noise_future = std::async( std::launch::async, [this, buffer, N, iteration]() {
+        const unsigned int seed = system.random_seed;
+        const Type::real amplitude = system.p.stochastic_amplitude;
+    #pragma omp parallel for schedule( static ) num_threads( system.noise_threads )
+        for ( int i = 0; i < N; i++ )
+            PC3::Kernel::generate_random_numbers( i, buffer, N, seed, iteration, amplitude, amplitude );
+    } );
+#else
+    if ( noise_stream == nullptr ) {
+        cudaStreamCreateWithFlags( &noise_stream, cudaStreamNonBlocking );
+        cudaEventCreateWithFlags( &noise_buffer_free, cudaEventDisableTiming );
+        cudaEventCreateWithFlags( &noise_ready, cudaEventDisableTiming );
+    }
+    // The buffer was read by the kernels of the previous iteration, which may still be running on the default stream
+    cudaEventRecord( noise_buffer_free, 0 );
+    cudaStreamWaitEvent( noise_stream, noise_buffer_free, 0 );
+    dim3 block_size( system.block_size, 1 );
+    dim3 grid_size( ( N + block_size.x ) / block_size.x, 1 );
+    CALL_PARTIAL_KERNEL(
+        PC3::Kernel::generate_random_numbers, "random_number_prefetch", grid_size, block_size, 0, noise_stream,
+        buffer, N, system.random_seed, iteration, system.p.stochastic_amplitude, system.p.stochastic_amplitude
+    );
+    cudaEventRecord( noise_ready, noise_stream );
+#endif
+}
+
+void PC3::Solver::awaitNoise() {
+    if ( noise_prefetched_iteration < 0 )
+        return;
+#ifdef USE_CPU
+    noise_future.wait();
+#else
+    // Only the default stream has to wait. The host continues to enqueue kernels.
+    cudaStreamWaitEvent( 0, noise_ready, 0 );
+#endif
+}
@@ -10,12 +10,26 @@
 // For now, use mutex, making the async call not really async if the matrices are too large.
 std::mutex mtx;
 
+// The FFT is kept unshifted on the device. Shift k = 0 to the center for output by remapping the indices.
+static PC3::Type::host_vector<PC3::Type::complex> shiftedFFT( const PC3::Type::complex* fft, const unsigned int N_x, const unsigned int N_y ) {
+    PC3::Type::host_vector<PC3::Type::complex> shifted( N_x * N_y );
+    for ( int i = 0; i < N_x * N_y; i++ )
+        shifted[i] = fft[PC3::Kernel::fft_shift_index( i, N_x, N_y )];
+    return shifted;
+}
+
 void PC3::Solver::outputMatrices( const unsigned int start_x, const unsigned int end_x, const unsigned int start_y, const unsigned int end_y, const unsigned int increment, const std::string& suffix, const std::string& prefix ) {
     const static std::vector<std::string> fileoutputkeys = { "wavefunction_plus", "wavefunction_minus", "reservoir_plus", "reservoir_minus", "fft_plus", "fft_minus" };
     auto header_information = PC3::FileHandler::Header( system.p.L_x * (end_x-start_x)/system.p.N_x, system.p.L_y* (end_y-start_y)/system.p.N_y, system.p.dx, system.p.dy, system.p.t );
     auto fft_header_information = PC3::FileHandler::Header( -1.0* (end_x-start_x)/system.p.N_x, -1.0* (end_y-start_y)/system.p.N_y, 2.0 / system.p.N_x, 2.0 / system.p.N_y, system.p.t );
+    // Without an FFT mask or with -ssfmMask, the FFT is not calculated during the iteration
+    if ( system.fft_every < system.t_max and ( system.fft_mask.size() == 0 or system.fft_mask_in_ssfm ) and system.doOutput( "fft_mask", "fft", "fft_plus", "fft_minus", "plus", "mat", "all" ) )
+        calculateVisualizationFFT();
     auto res = std::async( std::launch::async, [&]() {
         std::lock_guard<std::mutex> lock( mtx );
+        // Both FFT components live in the same stacked matrix, so synchronize it once before writing in parallel
+        if ( system.fft_every < system.t_max )
+            matrix.fft_plus.getHostPtr();
 #pragma omp parallel for
         for ( int i = 0; i < fileoutputkeys.size(); i++ ) {
             auto key = fileoutputkeys[i];
@@ -24,7 +38,7 @@ void PC3::Solver::outputMatrices( const unsigned int start_x, const unsigned int
             if ( key == "reservoir_plus" and system.doOutput( "mat", "reservoir", "n", "reservoir_plus", "n_plus", "plus", "rv", "mat", "all" ) )
                 filehandler.outputMatrixToFile( matrix.reservoir_plus.getHostPtr(), start_x, end_x, start_y, end_y, system.p.N_x, system.p.N_y, increment, header_information, prefix + key + suffix );
             if ( system.fft_every < system.t_max and key == "fft_plus" and system.doOutput( "fft_mask", "fft", "fft_plus", "plus", "mat", "all" ) )
-                filehandler.outputMatrixToFile( matrix.fft_plus.getHostPtr(), start_x, end_x, start_y, end_y, system.p.N_x, system.p.N_y, increment, fft_header_information, prefix + key + suffix );
+                filehandler.outputMatrixToFile( shiftedFFT( matrix.fft_plus.getHostPtr(), system.p.N_x, system.p.N_y ).data(), start_x, end_x, start_y, end_y, system.p.N_x, system.p.N_y, increment, fft_header_information, prefix + key + suffix );
             // Guard when not useing TE/TM splitting
             if ( not system.p.use_twin_mode )
                 continue;
@@ -33,7 +47,7 @@ void PC3::Solver::outputMatrices( const unsigned int start_x, const unsigned int
             if ( key == "reservoir_minus" and system.doOutput( "reservoir", "n", "reservoir_minus", "n_minus", "plus", "rv", "mat", "all" ) )
                 filehandler.outputMatrixToFile( matrix.reservoir_minus.getHostPtr(), start_x, end_x, start_y, end_y, system.p.N_x, system.p.N_y, increment, header_information, prefix + key + suffix );
             if ( system.fft_every < system.t_max and key == "fft_minus" and system.doOutput( "fft_mask", "fft", "fft_minus", "plus", "mat", "all" ) )
-                filehandler.outputMatrixToFile( matrix.fft_minus.getHostPtr(), start_x, end_x, start_y, end_y, system.p.N_x, system.p.N_y, increment, fft_header_information, prefix + key + suffix );
+                filehandler.outputMatrixToFile( shiftedFFT( matrix.fft_plus.getHostPtr() + system.p.N2, system.p.N_x, system.p.N_y ).data(), start_x, end_x, start_y, end_y, system.p.N_x, system.p.N_y, increment, fft_header_information, prefix + key + suffix );
         }
     } );
 }
@@ -64,7 +78,7 @@ void PC3::Solver::outputInitialMatrices() {
             std::string suffix = i > 0 ? "_" + std::to_string(i) : "";
             system.filehandler.outputMatrixToFile( matrix.potential_plus.getHostPtr()+i*system.p.N2, system.p.N_x, system.p.N_y, osc_header_information, "potential_plus" + suffix );
         }
-    if ( system.doOutput( "all", "mat", "fftplus", "fft" ) )
+    if ( matrix.use_fft and system.doOutput( "all", "mat", "fftplus", "fft" ) )
         system.filehandler.outputMatrixToFile( matrix.fft_mask_plus.getHostPtr(), system.p.N_x, system.p.N_y, header_information, "fft_mask_plus" );
     
     /////////////////////////////
@@ -96,6 +110,6 @@ void PC3::Solver::outputInitialMatrices() {
             std::string suffix = i > 0 ? "_" + std::to_string(i) : "";
             system.filehandler.outputMatrixToFile( matrix.potential_minus.getHostPtr()+i*system.p.N2, system.p.N_x, system.p.N_y, osc_header_information, "potential_minus" + suffix );
         }
-    if ( system.doOutput( "all", "mat", "fftminus", "fft" ) )
-        system.filehandler.outputMatrixToFile( matrix.fft_mask_minus.getHostPtr(), system.p.N_x, system.p.N_y, header_information, "fft_mask_minus" );
+    if ( matrix.use_fft and system.doOutput( "all", "mat", "fftminus", "fft" ) )
+        system.filehandler.outputMatrixToFile( matrix.fft_mask_plus.getHostPtr() + system.p.N2, system.p.N_x, system.p.N_y, header_information, "fft_mask_minus" );
 }
\ No newline at end of file
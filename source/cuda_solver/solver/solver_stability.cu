@@ -0,0 +1,139 @@
+#include <cmath>
+#include <complex>
+#include <functional>
+#include <map>
+#include <vector>
+#include <algorithm>
+#include "cuda/typedef.cuh"
+#include "solver/gpu_solver.hpp"
+#include "misc/commandline_io.hpp"
+
+// Stability function of the explicitly integrated terms of an iterator and whether the kinetic term is one of them
+struct ExplicitPart {
+    std::function<std::complex<double>( std::complex<double> )> stability_function;
+    bool kinetic;
+};
+
+// The split step and ADI iterators treat the kinetic term exactly or implicitly and the nonlinear terms using exponentials, so they are not listed
+static const std::map<std::string, ExplicitPart> explicit_parts = {
+    { "rk3", { PC3::Kernel::RK::Tableau::stability_function<PC3::Kernel::RK::Tableau::RK3>, true } },
+    { "rk4", { PC3::Kernel::RK::Tableau::stability_function<PC3::Kernel::RK::Tableau::RK4>, true } },
+    { "rk45", { PC3::Kernel::RK::Tableau::stability_function<PC3::Kernel::RK::Tableau::DP45>, true } },
+    { "rk23", { PC3::Kernel::RK::Tableau::stability_function<PC3::Kernel::RK::Tableau::BS32>, true } },
+    { "tsit5", { PC3::Kernel::RK::Tableau::stability_function<PC3::Kernel::RK::Tableau::Tsit5>, true } },
+    { "lsrk3", { PC3::Kernel::RK::Tableau::low_storage_stability_function<PC3::Kernel::RK::Tableau::LowStorage3>, true } },
+    { "lsrk4", { PC3::Kernel::RK::Tableau::low_storage_stability_function<PC3::Kernel::RK::Tableau::LowStorage4>, true } },
+    { "ifrk4", { PC3::Kernel::RK::Tableau::stability_function<PC3::Kernel::RK::Tableau::RK4>, false } },
+    { "sheun", { PC3::Kernel::RK::Tableau::stability_function<PC3::Kernel::RK::Tableau::StochasticHeun>, false } },
+};
+
+// Largest timestep for which R(lambda dt) stays within the unit circle for all eigenvalues lambda. The limit is bracketed by doubling and then bisected.
+static double stabilityLimit( const std::function<std::complex<double>( std::complex<double> )>& stability_function, const std::vector<std::complex<double>>& eigenvalues ) {
+    auto is_stable = [&]( const double dt ) {
+        return std::all_of( eigenvalues.begin(), eigenvalues.end(), [&]( const std::complex<double>& lambda ) { return std::abs( stability_function( lambda * dt ) ) <= 1.0 + 1E-12; } );
+    };
+    double largest_rate = 0.0;
+    for ( const auto& lambda : eigenvalues )
+        largest_rate = std::max( largest_rate, std::abs( lambda ) );
+    double stable = 0.0;
+    double unstable = 1.0 / largest_rate;
+    for ( int i = 0; i < 64 and is_stable( unstable ); i++ ) {
+        stable = unstable;
+        unstable *= 2.0;
+    }
+    for ( int i = 0; i < 64; i++ ) {
+        const double dt = 0.5 * ( stable + unstable );
+        ( is_stable( dt ) ? stable : unstable ) = dt;
+    }
+    return stable;
+}
+
+/**
+ * Estimates the largest stable timestep of the current iterator for the linearized GP equations.
+ * The eigenvalues of the wavefunction equation are bounded by
+ * ------------------------------------------------------------------------------
+ * kinetic:  i * ( |m_eff_scaled| + |delta_LT| ) / hbar * 4 ( 1/dx^2 + 1/dy^2 )      (spectral radius of the discrete Laplacian)
+ * local:    i * ( ( 2 g_c |Psi|^2 + g_r n + |V| + 2 |g_pm| |Psi|^2 ) / hbar + sqrt( |Psi|^2 * sqrt( R^2/4 + g_r^2/hbar^2 ) * 2 R n ) ) - gamma_c / 2
+ * ------------------------------------------------------------------------------
+ * The square root is the coupling between the wavefunction and the reservoir, which is treated as an
+ * oscillation. The TE/TM terms only contribute in the TE/TM mode. The reservoir decays with gamma_r + R |Psi|^2.
+ * |Psi|^2 and n are bounded by the initial state and by the steady state values P / gamma_c - gamma_r / R
+ * and P / gamma_r for the strongest pump P. Temporal envelopes are assumed to be bounded by one.
+ * For the explicit iterators, the timestep is the largest one for which all eigenvalues stay within
+ * the stability region of the iterator. The split step and ADI iterators are unconditionally stable,
+ * so the timestep is instead chosen to resolve the fastest local rate. The estimate then replaces
+ * the magic timestep, scaled by the safety factor. A timestep passed using --tstep is not changed.
+ * Without -autoDt, the estimate only warns if the timestep exceeds the limit.
+ */
+void PC3::Solver::estimateStableTimestep() {
+    auto& p = system.kernel_parameters;
+
+    // Upper bounds for the densities, the pumps and the potentials
+    double psi_norm_max = 0.0, reservoir_max = 0.0, pump_max = 0.0, potential_max = 0.0;
+    for ( int i = 0; i < p.N2; i++ ) {
+        psi_norm_max = std::max<double>( psi_norm_max, CUDA::abs2( matrix.initial_state_plus.getHostPtr()[i] ) );
+        reservoir_max = std::max<double>( reservoir_max, CUDA::abs( matrix.initial_reservoir_plus.getHostPtr()[i] ) );
+        if ( p.use_twin_mode ) {
+            psi_norm_max = std::max<double>( psi_norm_max, CUDA::abs2( matrix.initial_state_minus.getHostPtr()[i] ) );
+            reservoir_max = std::max<double>( reservoir_max, CUDA::abs( matrix.initial_reservoir_minus.getHostPtr()[i] ) );
+        }
+        double pump = 0.0, potential = 0.0;
+        for ( int g = 0; g < system.pump.groupSize(); g++ )
+            pump += CUDA::abs( matrix.pump_plus.getHostPtr()[i + g * p.N2] );
+        for ( int g = 0; g < system.potential.groupSize(); g++ )
+            potential += CUDA::abs( matrix.potential_plus.getHostPtr()[i + g * p.N2] );
+        pump_max = std::max( pump_max, pump );
+        potential_max = std::max( potential_max, potential );
+    }
+    if ( p.gamma_r > 0.0 )
+        reservoir_max = std::max<double>( reservoir_max, pump_max / p.gamma_r );
+    if ( p.gamma_c > 0.0 and p.R > 0.0 )
+        psi_norm_max = std::max<double>( psi_norm_max, pump_max / p.gamma_c - p.gamma_r / p.R );
+
+    const double laplace_radius = 4.0 * ( p.one_over_dx2 + p.one_over_dy2 );
+    const double kinetic_rate = ( std::abs( p.m_eff_scaled ) + ( p.use_twin_mode ? std::abs( p.delta_LT ) : 0.0 ) ) * laplace_radius / p.h_bar_s;
+    const double coupling_rate = std::sqrt( psi_norm_max * std::sqrt( 0.25 * p.R * p.R + p.g_r * p.g_r / ( p.h_bar_s * p.h_bar_s ) ) * 2.0 * p.R * reservoir_max );
+    const double local_rate = ( 2.0 * p.g_c * psi_norm_max + p.g_r * reservoir_max + potential_max + ( p.use_twin_mode ? 2.0 * std::abs( p.g_pm ) * psi_norm_max : 0.0 ) ) / p.h_bar_s + coupling_rate;
+    const double wavefunction_decay = 0.5 * p.gamma_c;
+    const double reservoir_decay = p.gamma_r + p.R * psi_norm_max;
+
+    std::cout << PC3::CLIO::prettyPrint( "Estimating the stable timestep for the '" + system.iterator + "' iterator...", PC3::CLIO::Control::Info ) << std::endl;
+    std::cout << PC3::CLIO::prettyPrint( "Kinetic rate: " + PC3::CLIO::to_str( kinetic_rate ) + " ps^-1 (Laplacian spectral radius " + PC3::CLIO::to_str( laplace_radius ) + " mum^-2)", PC3::CLIO::Control::Secondary ) << std::endl;
+    std::cout << PC3::CLIO::prettyPrint( "Local rate: " + PC3::CLIO::to_str( local_rate ) + " ps^-1 (|Psi|^2 <= " + PC3::CLIO::to_str( psi_norm_max ) + ", n <= " + PC3::CLIO::to_str( reservoir_max ) + ", |V| <= " + PC3::CLIO::to_str( potential_max ) + ")", PC3::CLIO::Control::Secondary ) << std::endl;
+    std::cout << PC3::CLIO::prettyPrint( "Reservoir decay rate: " + PC3::CLIO::to_str( reservoir_decay ) + " ps^-1", PC3::CLIO::Control::Secondary ) << std::endl;
+
+    double dt_limit;
+    std::string reasoning;
+    if ( explicit_parts.count( system.iterator ) ) {
+        const auto& part = explicit_parts.at( system.iterator );
+        // Sample the wavefunction spectrum parallel to the imaginary axis. The gain by the reservoir is physical and is not limited.
+        const double frequency_max = local_rate + ( part.kinetic ? kinetic_rate : 0.0 );
+        const int n_samples = 64;
+        std::vector<std::complex<double>> eigenvalues;
+        for ( int s = 0; s < n_samples; s++ )
+            eigenvalues.emplace_back( -wavefunction_decay, -frequency_max * s / ( n_samples - 1 ) );
+        // The multi-rate mode advances the reservoir exactly
+        if ( not p.multi_rate )
+            eigenvalues.emplace_back( -reservoir_decay, 0.0 );
+        // Imaginary time propagation rotates the spectrum
+        if ( system.imag_time_amplitude != 0.0 )
+            for ( auto& lambda : eigenvalues )
+                lambda *= std::complex<double>( 0.0, -1.0 );
+        dt_limit = stabilityLimit( part.stability_function, eigenvalues );
+        reasoning = std::string( "stability limit of the explicit " ) + ( part.kinetic ? "kinetic and local terms" : "local terms" );
+    } else {
+        const double rate_max = std::max( local_rate + wavefunction_decay, reservoir_decay );
+        dt_limit = rate_max > 0.0 ? 1.0 / rate_max : system.magic_timestep;
+        reasoning = "unconditionally stable, resolving the fastest local rate";
+    }
+
+    const double dt = system.auto_dt_safety * dt_limit;
+    std::cout << PC3::CLIO::prettyPrint( "Largest timestep: " + PC3::CLIO::to_str( dt_limit ) + " ps (" + reasoning + ")", PC3::CLIO::Control::Secondary ) << std::endl;
+    if ( not system.auto_dt or not system.do_overwrite_dt ) {
+        if ( p.dt > dt_limit )
+            std::cout << PC3::CLIO::prettyPrint( "dt = " + PC3::CLIO::to_str( p.dt ) + ( system.do_overwrite_dt ? " (magic timestep)" : " passed using --tstep" ) + " exceeds the estimated largest timestep " + PC3::CLIO::to_str( dt_limit ) + " ps! Use -autoDt or a smaller --tstep.", PC3::CLIO::Control::Warning ) << std::endl;
+        return;
+    }
+    p.dt = dt;
+    std::cout << PC3::CLIO::prettyPrint( "Using dt = " + PC3::CLIO::to_str( system.auto_dt_safety ) + " * " + PC3::CLIO::to_str( dt_limit ) + " = " + PC3::CLIO::to_str( dt ) + " ps instead of the magic timestep " + PC3::CLIO::to_str( system.magic_timestep ) + " ps", PC3::CLIO::Control::Secondary | PC3::CLIO::Control::Success ) << std::endl;
+}
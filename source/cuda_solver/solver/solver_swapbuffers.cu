@@ -1,4 +1,5 @@
 #include "solver/gpu_solver.hpp"
+#include "kernel/kernel_compute.cuh"
 
 void PC3::Solver::swapBuffers() {
     matrix.wavefunction_plus.swap( matrix.buffer_wavefunction_plus );
@@ -7,4 +8,34 @@ void PC3::Solver::swapBuffers() {
         matrix.wavefunction_minus.swap( matrix.buffer_wavefunction_minus );
         matrix.reservoir_minus.swap( matrix.buffer_reservoir_minus );
     }
-}
\ No newline at end of file
+}
+void PC3::Solver::swapKMatrices( int first, int second ) {
+    std::vector<PC3::CUDAMatrix<Type::complex>*> k_wavefunction = { &matrix.k1_wavefunction_plus, &matrix.k2_wavefunction_plus, &matrix.k3_wavefunction_plus, &matrix.k4_wavefunction_plus, &matrix.k5_wavefunction_plus, &matrix.k6_wavefunction_plus, &matrix.k7_wavefunction_plus, &matrix.k8_wavefunction_plus, &matrix.k9_wavefunction_plus, &matrix.k10_wavefunction_plus };
+    std::vector<PC3::CUDAMatrix<Type::complex>*> k_reservoir_plus = { &matrix.k1_reservoir_plus, &matrix.k2_reservoir_plus, &matrix.k3_reservoir_plus, &matrix.k4_reservoir_plus, &matrix.k5_reservoir_plus, &matrix.k6_reservoir_plus, &matrix.k7_reservoir_plus, &matrix.k8_reservoir_plus, &matrix.k9_reservoir_plus, &matrix.k10_reservoir_plus };
+    std::vector<PC3::CUDAMatrix<Type::complex>*> k_reservoir_minus = { &matrix.k1_reservoir_minus, &matrix.k2_reservoir_minus, &matrix.k3_reservoir_minus, &matrix.k4_reservoir_minus, &matrix.k5_reservoir_minus, &matrix.k6_reservoir_minus, &matrix.k7_reservoir_minus, &matrix.k8_reservoir_minus, &matrix.k9_reservoir_minus, &matrix.k10_reservoir_minus };
+    std::vector<PC3::CUDAMatrix<Type::complex>*> k_wavefunction_minus = { &matrix.k1_wavefunction_minus, &matrix.k2_wavefunction_minus, &matrix.k3_wavefunction_minus, &matrix.k4_wavefunction_minus, &matrix.k5_wavefunction_minus, &matrix.k6_wavefunction_minus, &matrix.k7_wavefunction_minus, &matrix.k8_wavefunction_minus, &matrix.k9_wavefunction_minus, &matrix.k10_wavefunction_minus };
+    // The minus wavefunction is stacked behind the plus wavefunction and is swapped with it, unless the matrices are padded
+    k_wavefunction[first]->swap( *k_wavefunction[second] );
+    if ( system.p.use_twin_mode and matrix.k_stack == 1 )
+        k_wavefunction_minus[first]->swap( *k_wavefunction_minus[second] );
+    k_reservoir_plus[first]->swap( *k_reservoir_plus[second] );
+    if ( system.p.use_twin_mode )
+        k_reservoir_minus[first]->swap( *k_reservoir_minus[second] );
+}
+void PC3::Solver::swapDenseOutput() {
+    matrix.wavefunction_plus.swap( matrix.dense_wavefunction_plus );
+    matrix.reservoir_plus.swap( matrix.dense_reservoir_plus );
+    if ( system.p.use_twin_mode ) {
+        matrix.wavefunction_minus.swap( matrix.dense_wavefunction_minus );
+        matrix.reservoir_minus.swap( matrix.dense_reservoir_minus );
+    }
+}
+void PC3::Solver::fillHalo( Type::complex* plus, Type::complex* minus ) {
+    // With zero boundaries in y, the halo stays zero
+    if ( not system.p.halo_padding or not system.p.periodic_boundary_y )
+        return;
+    dim3 block_size( system.block_size, 1 );
+    CALL_LINE_KERNEL( PC3::Kernel::fill_halo, "fill_halo", system.p.N_x, block_size, plus, system.p.N_x, system.p.N_y );
+    if ( system.p.use_twin_mode )
+        CALL_LINE_KERNEL( PC3::Kernel::fill_halo, "fill_halo", system.p.N_x, block_size, minus, system.p.N_x, system.p.N_y );
+}
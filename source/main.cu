@@ -55,29 +55,38 @@ int main( int argc, char* argv[] ) {
     double complete_duration = 0.;
     size_t out_every_iterations = 1;
     PC3::Type::real dt = system.p.dt;
+    // The RK iterators interpolate the state at the output times, so their timestep is never shortened
+    const bool dense_output = solver.useDenseOutput();
 
     // Main Loop
     while ( system.p.t < system.t_max and running ) {
         TimeThis(
             // Iterate #output_every ps
             auto start = system.p.t;
+            // Timesteps fused by the wavefront sweep must not pass the next output
+            solver.next_output_time = system.disableRender ? out_every_iterations*system.output_every : start+system.output_every;
             while ( ((not system.disableRender and system.p.t < start+system.output_every ) or (system.disableRender and system.p.t < out_every_iterations*system.output_every)) and solver.iterate() ) {
-                // If we use live rendering, do not adjust dt
-                if (not system.disableRender)
+                // If we use live rendering or the dense output, do not adjust dt
+                if (not system.disableRender or dense_output)
                     continue;
                 // Check if t+dt would overshoot out_every_iterations*output_every, adjust dt accordingly
-                system.p.dt = dt;
+                // Adaptive iterators start from their own proposed timestep instead
+                system.p.dt = solver.proposed_dt > 0.0 ? solver.proposed_dt : dt;
                 if ( system.p.t + system.p.dt > out_every_iterations*system.output_every ) {
                     auto next_dt = out_every_iterations*system.output_every - system.p.t;
                     if (next_dt > 0)
                         system.p.dt = next_dt;
                 }
             }
+            // Replace the state by the dense output at the output time if the last step overshot it
+            if (dense_output)
+                solver.beginDenseOutput( out_every_iterations*system.output_every );
             out_every_iterations++;
             // Cache the history and max values
             solver.cacheValues();
             // Output Matrices if enabled
             solver.cacheMatrices();
+            solver.endDenseOutput();
             // Plot
             running = plotSFMLWindow( solver, system.p.t, complete_duration, system.iteration );
         , "Main-Loop" );
@@ -0,0 +1,68 @@
+#include <cmath>
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+#include "system/step_size_controller.hpp"
+
+bool PC3::StepSizeController::update( Type::real error, Type::real dt, int embedded_order, Type::real dt_min, Type::real dt_max, Type::real& next_dt ) {
+    const Type::real k = embedded_order + 1.0;
+
+    // A NaN error is always rejected and the timestep is decreased as much as possible
+    if ( std::isnan( error ) ) {
+        rejected_steps++;
+        last_step_rejected = true;
+        next_dt = std::max<Type::real>( dt * min_factor, dt_min );
+        return dt <= dt_min;
+    }
+    // Avoid division by zero for vanishing errors. The growth is bounded by max_factor anyways.
+    error = std::max<Type::real>( error, 1E-10 );
+
+    const bool accept = error <= 1.0 or dt <= dt_min;
+    Type::real factor;
+    if ( accept ) {
+        Type::real b1 = 1.0, b2 = 0.0, b3 = 0.0;
+        if ( mode == Mode::PI ) {
+            b1 = 0.7;
+            b2 = -0.4;
+        } else if ( mode == Mode::PID ) {
+            b1 = 0.25;
+            b2 = 0.5;
+            b3 = 0.25;
+        }
+        factor = safety * std::pow( error, -b1 / k ) * std::pow( previous_errors[0], -b2 / k ) * std::pow( previous_errors[1], -b3 / k );
+        // Do not increase the timestep directly after a rejection
+        if ( last_step_rejected )
+            factor = std::min<Type::real>( factor, 1.0 );
+        previous_errors[1] = previous_errors[0];
+        previous_errors[0] = error;
+        last_step_rejected = false;
+
+        accepted_steps++;
+        last_dt = dt;
+        smallest_dt = std::min( smallest_dt, dt );
+        largest_dt = std::max( largest_dt, dt );
+    } else {
+        factor = safety * std::pow( error, -1.0 / k );
+        last_step_rejected = true;
+        rejected_steps++;
+    }
+
+    factor = std::min<Type::real>( std::max<Type::real>( factor, min_factor ), max_factor );
+    next_dt = std::min<Type::real>( std::max<Type::real>( dt * factor, dt_min ), dt_max );
+    return accept;
+}
+
+bool PC3::StepSizeController::isUsed() const {
+    return accepted_steps + rejected_steps > 0;
+}
+
+std::string PC3::StepSizeController::toString() const {
+    const unsigned int total = accepted_steps + rejected_steps;
+    std::stringstream ss;
+    ss << " = Accepted steps: " << accepted_steps << std::endl;
+    ss << " = Rejected steps: " << rejected_steps << " (" << std::fixed << std::setprecision( 1 ) << ( total > 0 ? 100.0 * rejected_steps / total : 0.0 ) << "%)" << std::endl;
+    ss << std::defaultfloat << std::setprecision( 6 );
+    if ( accepted_steps > 0 )
+        ss << " = Accepted dt range: " << smallest_dt << " ... " << largest_dt << " ps" << std::endl;
+    return ss.str();
+}
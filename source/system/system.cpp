@@ -44,17 +44,32 @@ PC3::SystemParameters::SystemParameters() {
     // RK Solver Variables
     p.t = 1000;
     output_every = 1;
+    dense_output = true;
     dt_max = 3;
     dt_min = 0.0001; // also dt_delta
     tolerance = 1E-1;
+    absolute_tolerance = 1E-6;
+    relative_tolerance = 1E-4;
+    error_norm_reservoir = false;
     do_overwrite_dt = true;
+    auto_dt = false;
+    auto_dt_safety = 0.8;
 
     // FFT Mask every x ps
     fft_every = 1; // ps
+    // Default FFTW planner and no wisdom file
+    fft_planner = "estimate";
+    fft_wisdom_file = "";
+    // By Default, the FFT mask is applied using a separate FFT round trip
+    fft_mask_in_ssfm = false;
 
     // Kernel Block Size
     block_size = 256;
     omp_max_threads = omp_get_max_threads();
+    noise_threads = 1;
+    wavefront = false;
+    wavefront_rows = 0;
+    wavefront_steps = 1;
 
     // Default Solver is RK4
     iterator = "rk4";
@@ -45,6 +45,8 @@ void PC3::SystemParameters::init( int argc, char** argv ) {
     if ( ( index = PC3::CLIO::findInArgv( "--threads", argc, argv ) ) != -1 )
         omp_max_threads = (int)PC3::CLIO::getNextInput( argv, argc, "threads", ++index );
     omp_set_num_threads( omp_max_threads );
+    if ( ( index = PC3::CLIO::findInArgv( "--noiseThreads", argc, argv ) ) != -1 )
+        noise_threads = (int)PC3::CLIO::getNextInput( argv, argc, "noise_threads", ++index );
 
     if ( ( index = PC3::CLIO::findInArgv( "--blocksize", argc, argv ) ) != -1 )
         block_size = (int)PC3::CLIO::getNextInput( argv, argc, "block_size", ++index );
@@ -85,8 +87,44 @@ void PC3::SystemParameters::init( int argc, char** argv ) {
         do_overwrite_dt = false;
         std::cout << PC3::CLIO::prettyPrint( "Overwritten (initial) dt to " + PC3::CLIO::to_str(p.dt), PC3::CLIO::Control::Warning) << std::endl;
     }
+    if ( ( index = PC3::CLIO::findInArgv( "-autoDt", argc, argv ) ) != -1 ) {
+        auto_dt = true;
+    }
+    if ( ( index = PC3::CLIO::findInArgv( "--dtSafety", argc, argv ) ) != -1 ) {
+        auto_dt_safety = PC3::CLIO::getNextInput( argv, argc, "dt_safety", ++index );
+    }
     if ( ( index = PC3::CLIO::findInArgv( "--tol", argc, argv ) ) != -1 ) {
         tolerance = PC3::CLIO::getNextInput( argv, argc, "tol", ++index );
+        relative_tolerance = tolerance;
+    }
+    if ( ( index = PC3::CLIO::findInArgv( "--rtol", argc, argv ) ) != -1 ) {
+        relative_tolerance = PC3::CLIO::getNextInput( argv, argc, "rtol", ++index );
+    }
+    if ( ( index = PC3::CLIO::findInArgv( "--atol", argc, argv ) ) != -1 ) {
+        absolute_tolerance = PC3::CLIO::getNextInput( argv, argc, "atol", ++index );
+    }
+    if ( ( index = PC3::CLIO::findInArgv( "-errorReservoir", argc, argv ) ) != -1 ) {
+        error_norm_reservoir = true;
+    }
+    p.multi_rate = false;
+    if ( ( index = PC3::CLIO::findInArgv( "-multiRate", argc, argv ) ) != -1 ) {
+        p.multi_rate = true;
+    }
+    p.halo_padding = false;
+    if ( ( index = PC3::CLIO::findInArgv( "-haloPadding", argc, argv ) ) != -1 ) {
+        p.halo_padding = true;
+    }
+    if ( ( index = PC3::CLIO::findInArgv( "--wavefront", argc, argv ) ) != -1 ) {
+        wavefront = true;
+        wavefront_rows = (int)PC3::CLIO::getNextInput( argv, argc, "wavefront_rows", ++index );
+        wavefront_steps = std::max( 1, (int)PC3::CLIO::getNextInput( argv, argc, "wavefront_steps", index ) );
+    }
+    if ( ( index = PC3::CLIO::findInArgv( "--controller", argc, argv ) ) != -1 ) {
+        std::string controller = PC3::CLIO::getNextStringInput( argv, argc, "controller", ++index );
+        if ( StepSizeController::ModeFromString.count( controller ) )
+            step_size_controller.mode = StepSizeController::ModeFromString.at( controller );
+        else
+            std::cout << PC3::CLIO::prettyPrint( "Unknown step size controller '" + controller + "'. Using the PI controller.", PC3::CLIO::Control::Warning ) << std::endl;
     }
     if ( ( index = PC3::CLIO::findInArgv( "--rk45dt", argc, argv ) ) != -1 ) {
         dt_min = PC3::CLIO::getNextInput( argv, argc, "dt_min", ++index );
@@ -100,6 +138,15 @@ void PC3::SystemParameters::init( int argc, char** argv ) {
     if ( ( index = PC3::CLIO::findInArgv( "--fftEvery", argc, argv ) ) != -1 ) {
         fft_every = PC3::CLIO::getNextInput( argv, argc, "fft_every", ++index );
     }
+    if ( ( index = PC3::CLIO::findInArgv( "-ssfmMask", argc, argv ) ) != -1 ) {
+        fft_mask_in_ssfm = true;
+    }
+    if ( ( index = PC3::CLIO::findInArgv( "--fftPlanner", argc, argv ) ) != -1 ) {
+        fft_planner = PC3::CLIO::getNextStringInput( argv, argc, "fft_planner", ++index );
+    }
+    if ( ( index = PC3::CLIO::findInArgv( "--fftWisdom", argc, argv ) ) != -1 ) {
+        fft_wisdom_file = PC3::CLIO::getNextStringInput( argv, argc, "fft_wisdom", ++index );
+    }
 
     // Choose the iterator
     iterator = "rk4";
@@ -111,6 +158,9 @@ void PC3::SystemParameters::init( int argc, char** argv ) {
         //std::cout << PC3::CLIO::prettyPrint( "Currently not implemented. Using default iterator RK4.", PC3::CLIO::Control::FullWarning) << std::endl;
         iterator = "ssfm";
     }
+    if ( ( index = PC3::CLIO::findInArgv( "-assfm", argc, argv ) ) != -1 ) {
+        iterator = "assfm";
+    }
     if ( ( index = PC3::CLIO::findInArgv( "--iterator", argc, argv ) ) != -1 ) {
         std::string it = PC3::CLIO::getNextStringInput( argv, argc, "iterator", ++index );
         iterator = it;
@@ -154,6 +204,8 @@ void PC3::SystemParameters::init( int argc, char** argv ) {
 
     if ( ( index = PC3::CLIO::findInArgv( "--outEvery", argc, argv ) ) != -1 )
         output_every = PC3::CLIO::getNextInput( argv, argc, "output_every", ++index );
+    if ( ( index = PC3::CLIO::findInArgv( "-noDenseOutput", argc, argv ) ) != -1 )
+        dense_output = false;
 
     p.periodic_boundary_x = false;
     p.periodic_boundary_y = false;
@@ -57,6 +57,7 @@ void PC3::SystemParameters::printHelp() {
         //<< PC3::CLIO::unifyLength( "--loadFrom", "<string> <string...>", "Loads list of matrices from path." ) << std::endl
         << PC3::CLIO::unifyLength( "--config", "<string>", "Loads configuration from file." ) << std::endl
         << PC3::CLIO::unifyLength( "--outEvery", "<int>", "Number of Runge-Kutta iterations for each plot. Standard is every " + std::to_string( output_every ) + " ps" ) << std::endl
+        << PC3::CLIO::unifyLength( "-noDenseOutput", "no arguments", "Shorten the last timestep before each output instead of interpolating the state at the output time. Only affects the RK iterators with -nosfml" ) << std::endl
         << PC3::CLIO::unifyLength( "--output", "<string...>", "Comma seperated list of things to output. Available: mat,scalar,fft,pump,mask,psi,n. Many can also be specified with _plus or _minus." ) << std::endl
         //<< PC3::CLIO::unifyLength( "--history", "<Y> <points>", "Outputs a maximum number of x-slices at Y for history. y-slices are not supported." ) << std::endl
         << PC3::CLIO::unifyLength( "--historyMatrix", "<int> <int> <int> <int> <int>", "Outputs the matrices specified in --output with specified startx,endx,starty,endy index and increment." ) << std::endl
@@ -67,12 +68,22 @@ void PC3::SystemParameters::printHelp() {
               << PC3::CLIO::unifyLength( "Flag", "Inputs", "Description" ) << std::endl
               << PC3::CLIO::unifyLength( "--N", "<int> <int>", "Grid Dimensions (N x N). Standard is " + std::to_string( p.N_x ) + " x " + std::to_string( p.N_y ) ) << std::endl
               << PC3::CLIO::unifyLength( "--tstep", "<double>", "Timestep, standard is magic-timestep = " + PC3::CLIO::to_str( magic_timestep ) + "ps" ) << std::endl
+              << PC3::CLIO::unifyLength( "-autoDt", "no arguments", "Use the largest stable timestep of the iterator instead of the magic timestep. Estimated from the spectral radius of the Laplacian, the initial state, the pumps and the potentials" ) << std::endl
+              << PC3::CLIO::unifyLength( "--dtSafety", "<double>", "Safety factor for -autoDt, standard is " + PC3::CLIO::to_str( auto_dt_safety ) ) << std::endl
               << PC3::CLIO::unifyLength( "--tmax", "<double>", "Timelimit, standard is " + PC3::CLIO::to_str( t_max ) + " ps" ) << std::endl
-              << PC3::CLIO::unifyLength( "--iterator", "<string>", "RK4, RK45 or SSFM" ) << std::endl
+              << PC3::CLIO::unifyLength( "--iterator", "<string>", "RK3, RK4, SHEUN (stochastic Heun for --dw with exact k-space kinetic term), RK45 (Dormand-Prince), RK23 (Bogacki-Shampine), TSIT5 (Tsitouras), SSFM, SSFM4, SSFM6 (fourth and sixth order splitting), ASSFM (adaptive SSFM), IFRK4 (RK4 with exact k-space kinetic term), ADI (implicit kinetic term, no TE/TM), LSRK3 or LSRK4 (low storage RK with a single K matrix)" ) << std::endl
               << PC3::CLIO::unifyLength( "-rk45", "no arguments", "Shortcut to use RK45" ) << std::endl
-              << PC3::CLIO::unifyLength( "--rk45dt", "<double> <double>", "dt_min and dt_max for the RK45 method" ) << std::endl
-              << PC3::CLIO::unifyLength( "--tol", "<double>", "RK45 Tolerance, standard is " + PC3::CLIO::to_str( tolerance ) + " ps" ) << std::endl
+              << PC3::CLIO::unifyLength( "--rk45dt", "<double> <double>", "dt_min and dt_max for the RK45 and adaptive SSFM methods" ) << std::endl
+              << PC3::CLIO::unifyLength( "--tol", "<double>", "Tolerance of the adaptive RK and SSFM iterators. Same as --rtol" ) << std::endl
+              << PC3::CLIO::unifyLength( "--rtol", "<double>", "Relative tolerance of the adaptive RK and SSFM iterators, standard is " + PC3::CLIO::to_str( relative_tolerance ) ) << std::endl
+              << PC3::CLIO::unifyLength( "--atol", "<double>", "Absolute tolerance of the adaptive RK and SSFM iterators, standard is " + PC3::CLIO::to_str( absolute_tolerance ) ) << std::endl
+              << PC3::CLIO::unifyLength( "--controller", "<string>", "Step size controller of the adaptive RK and SSFM iterators. Either 'i', 'pi' (standard) or 'pid'" ) << std::endl
+              << PC3::CLIO::unifyLength( "-errorReservoir", "no arguments", "Include the reservoir in the error norm of the adaptive RK and SSFM iterators" ) << std::endl
+              << PC3::CLIO::unifyLength( "-multiRate", "no arguments", "Advance the reservoir using its exact exponential solution once per step instead of the RK stages. Only affects the RK3, RK4, RK45, RK23 and TSIT5 iterators" ) << std::endl
+              << PC3::CLIO::unifyLength( "-haloPadding", "no arguments", "Pad the matrices by halo rows so the neighbour stencils skip the bounds checks in y. Only affects the RK3, RK4, RK45, RK23 and TSIT5 iterators" ) << std::endl
+              << PC3::CLIO::unifyLength( "--wavefront", "<int> <int>", "Sweep the RK3 and RK4 stages over bands of rows while they are in the cache (CPU only). Band height in rows (0 chooses it from the grid width) and largest number of timesteps fused into one sweep" ) << std::endl
               << PC3::CLIO::unifyLength( "-ssfm", "no arguments", "Shortcut to use SSFM" ) << std::endl
+              << PC3::CLIO::unifyLength( "-assfm", "no arguments", "Shortcut to use the adaptive SSFM using step doubling" ) << std::endl
               << PC3::CLIO::unifyLength( "--imagTime", "<double>", "Use imaginary time propagation with a given norm. Currently only works in conjunction with -ssfm/--iterator ssfm" ) << std::endl
               << PC3::CLIO::unifyLength( "--boundary", "<string> <string>", "Boundary conditions for x and y. Is either 'periodic' or 'zero'." ) << std::endl;
     std::cout << PC3::CLIO::fillLine( console_width, seperator ) << std::endl;
@@ -103,7 +114,9 @@ void PC3::SystemParameters::printHelp() {
               << PC3::CLIO::unifyLength( "--fftMask", "Spatial", "" ) << std::endl
               << "Additional Parameters:" << std::endl
               << PC3::CLIO::unifyLength( "--fftEvery", "<int>", "Apply FFT Filter every x ps" ) << std::endl
-              << PC3::CLIO::unifyLength( "--initRandom", "<double>", "Amplitude. Randomly initialize Psi" ) << std::endl;
+              << PC3::CLIO::unifyLength( "-ssfmMask", "no arguments", "Apply the FFT Filter within the next linear SSFM half step instead of a separate FFT. Only works in conjunction with -ssfm/--iterator ssfm, ssfm4 or ssfm6" ) << std::endl
+              << PC3::CLIO::unifyLength( "--initRandom", "<double>", "Amplitude. Randomly initialize Psi" ) << std::endl
+              << PC3::CLIO::unifyLength( "--noiseThreads", "<int>", "Threads generating the noise of the next iteration in the background for --dw. On the GPU, a separate stream is used for any value > 0. 0 generates the noise synchronously. Standard is " + std::to_string( noise_threads ) ) << std::endl;
     std::cout << PC3::CLIO::fillLine( console_width, seperator ) << std::endl;
     std::cout << PC3::CLIO::unifyLength( "SI Scalings", "", "" ) << std::endl
               << PC3::CLIO::unifyLength( "Flag", "Inputs", "Description" ) << std::endl
@@ -113,7 +126,9 @@ void PC3::SystemParameters::printHelp() {
               << PC3::CLIO::unifyLength( "--hbarscaled", "<double>", "Standard is " + PC3::CLIO::to_str( p.h_bar_s ) ) << std::endl
               << PC3::CLIO::unifyLength( "--meff", "<double>", "Standard is " + PC3::CLIO::to_str( p.m_eff ) ) << std::endl;
 #ifdef USE_CPU
-    std::cout << PC3::CLIO::unifyLength( "--threads", "<int>", "Standard is " + std::to_string( omp_max_threads ) + " Threads\n" ) << std::endl;
+    std::cout << PC3::CLIO::unifyLength( "--threads", "<int>", "Standard is " + std::to_string( omp_max_threads ) + " Threads" ) << std::endl
+              << PC3::CLIO::unifyLength( "--fftPlanner", "<string>", "FFTW planner rigor. Either estimate, measure, patient or exhaustive. Standard is " + fft_planner ) << std::endl
+              << PC3::CLIO::unifyLength( "--fftWisdom", "<string>", "FFTW wisdom file. Imported on startup and exported when the calculation finishes.\n" ) << std::endl;
 #endif
 }
 
@@ -163,15 +178,19 @@ void PC3::SystemParameters::printSummary( std::map<std::string, std::vector<doub
     std::cout << EscapeSequence::BOLD << PC3::CLIO::centerString( " Infos ", console_width, '-' ) << EscapeSequence::RESET << std::endl;
     
     std::cout << "Calculations done using the '" << iterator << "' solver" << std::endl;
-    if ( iterator == "rk45" ) {
-        std::cout << " = Tolerance used: " << tolerance << std::endl;
+    if ( iterator == "rk45" or iterator == "rk23" or iterator == "tsit5" or iterator == "assfm" ) {
         std::cout << " = dt_max used: " << dt_max << std::endl;
         std::cout << " = dt_min used: " << dt_min << std::endl;
     }
+    if ( step_size_controller.isUsed() ) {
+        std::cout << " = Relative tolerance used: " << relative_tolerance << std::endl;
+        std::cout << " = Absolute tolerance used: " << absolute_tolerance << ( error_norm_reservoir ? " (including the reservoir)" : "" ) << std::endl;
+        std::cout << step_size_controller.toString();
+    }
 
     std::cout << "Calculated until t = " << p.t << "ps" << std::endl;
     if ( fft_mask.size() > 0 )
-        std::cout << "Applying FFT every " << fft_every << " ps" << std::endl;
+        std::cout << "Applying FFT every " << fft_every << " ps" << ( fft_mask_in_ssfm ? " within the SSFM linear step" : "" ) << std::endl;
     std::cout << "Output variables and plots every " << output_every << " ps" << std::endl;
     std::cout << "Total allocated space for Device Matrices: " << CUDAMatrixBase::global_total_device_mb_max << " MB." << std::endl;
     std::cout << "Total allocated space for Host Matrices: " << CUDAMatrixBase::global_total_host_mb_max << " MB." << std::endl;
@@ -184,6 +203,7 @@ void PC3::SystemParameters::printSummary( std::map<std::string, std::vector<doub
 #ifdef USE_CPU
     std::cout << "Device Used: " << EscapeSequence::BOLD << EscapeSequence::YELLOW << "CPU" << EscapeSequence::RESET << std::endl;
     std::cout << EscapeSequence::GRAY << "  CPU cores utilized: " << omp_max_threads << EscapeSequence::RESET << std::endl;
+    std::cout << EscapeSequence::GRAY << "  FFTW planner: " << fft_planner << ( fft_wisdom_file.empty() ? "" : ", wisdom file: " + fft_wisdom_file ) << EscapeSequence::RESET << std::endl;
 #else
 // The Headers required for this come from system_parameters.hpp->typedef.cuh
     int nDevices;
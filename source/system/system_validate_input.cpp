@@ -44,6 +44,33 @@ void PC3::SystemParameters::validateInputs() {
         std::cout << PC3::CLIO::prettyPrint( "dt_min = " + PC3::CLIO::to_str( dt_min ) + " cannot be negative!", PC3::CLIO::Control::Warning) << std::endl;
         valid = false;
     }
+    if ( auto_dt_safety <= 0 or auto_dt_safety > 1 ) {
+        std::cout << PC3::CLIO::prettyPrint( "dt safety factor = " + PC3::CLIO::to_str( auto_dt_safety ) + " has to be within (0, 1]!", PC3::CLIO::Control::Warning) << std::endl;
+        valid = false;
+    }
+    if ( absolute_tolerance < 0 or relative_tolerance < 0 or absolute_tolerance + relative_tolerance <= 0 ) {
+        std::cout << PC3::CLIO::prettyPrint( "atol = " + PC3::CLIO::to_str( absolute_tolerance ) + " and rtol = " + PC3::CLIO::to_str( relative_tolerance ) + " cannot be negative or both zero!", PC3::CLIO::Control::Warning) << std::endl;
+        valid = false;
+    }
+    if ( fft_planner != "estimate" and fft_planner != "measure" and fft_planner != "patient" and fft_planner != "exhaustive" ) {
+        std::cout << PC3::CLIO::prettyPrint( "FFT planner '" + fft_planner + "' is unknown! Use estimate, measure, patient or exhaustive.", PC3::CLIO::Control::Warning) << std::endl;
+        valid = false;
+    }
+    if ( fft_mask_in_ssfm and iterator != "ssfm" and iterator != "ssfm4" and iterator != "ssfm6" ) {
+        std::cout << PC3::CLIO::prettyPrint( "-ssfmMask only works in conjunction with the SSFM iterator. Applying the FFT Filter separately.", PC3::CLIO::Control::Warning) << std::endl;
+        fft_mask_in_ssfm = false;
+    }
+    if ( iterator == "adi" and p.use_twin_mode ) {
+        std::cout << PC3::CLIO::prettyPrint( "The ADI iterator does not support TE/TM splitting!", PC3::CLIO::Control::Warning) << std::endl;
+        valid = false;
+    }
+    if ( iterator == "assfm" and p.stochastic_amplitude > 0.0 ) {
+        std::cout << PC3::CLIO::prettyPrint( "The adaptive SSFM iterator does not support stochastic noise, because the step doubling error estimate would include the noise!", PC3::CLIO::Control::Warning ) << std::endl;
+        valid = false;
+    }
+    if ( imag_time_amplitude != 0.0 and ( iterator == "ssfm4" or iterator == "ssfm6" ) ) {
+        std::cout << PC3::CLIO::prettyPrint( "The higher order SSFM iterators use negative sub-steps, which may be unstable for imaginary time propagation!", PC3::CLIO::Control::Warning ) << std::endl;
+    }
     if (abs( p.dt > 1.1*magic_timestep )) {
         std::cout << PC3::CLIO::prettyPrint( "dt = " + PC3::CLIO::to_str( p.dt ) + " is very large! Is this intended?", PC3::CLIO::Control::Warning) << std::endl;
     }
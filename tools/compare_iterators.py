@@ -0,0 +1,88 @@
+import argparse
+import math
+import os
+import subprocess
+import sys
+import tempfile
+
+"""
+-----------------------------------------------------------------------------------
+
+                  _____    _     _            _______   _______
+                 |_____]   |     |   |        |______   |______
+                 |       . |_____| . |_____ . ______| . |______ .
+
+        Paderborn Ultrafast SoLver for the nonlinear Schroedinger Equation
+
+-----------------------------------------------------------------------------------
+
+Consistency Check between two Iterators
+
+Runs the same system with a reference iterator and a test iterator and compares
+the final wavefunctions. Exits with a nonzero status if the relative L2 error of
+any component exceeds the tolerance. The default system is a periodic TE/TM run
+starting from the plus component only, so the minus component is created by the
+TE/TM coupling alone. This checks the k-space propagators of the split step and
+integrating factor iterators against the real space stencil of the Runge-Kutta
+iterators. Compare the iterators on a periodic grid with a smooth state, otherwise
+the finite difference and spectral derivatives differ by more than the tolerance.
+
+Usage:
+    python compare_iterators.py --program <path_to_pulse> [--reference rk4] [--iterator ssfm] [--tolerance 1e-1] [-- <system arguments>]
+"""
+
+default_system = [
+    "--N", "64", "64", "--L", "20", "20", "--tmax", "1", "--tstep", "0.005", "--boundary", "periodic", "periodic",
+    "--initialState", "0.1", "add", "2", "2", "0", "0", "plus", "1", "0", "gauss+noDivide",
+    "-tetm", "--outEvery", "1", "-nosfml",
+]
+
+
+def load_complex_matrix(filename: str) -> list:
+    """
+    Loads a P.U.L.S.E. complex matrix. The real part is followed by the imaginary part.
+    :param filename: Path to the matrix file
+    """
+    with open(filename, "r") as f:
+        rows = [[float(v) for v in line.split()] for line in f if line.strip() and not line.startswith("#")]
+    half = len(rows) // 2
+    return [complex(re, im) for row_re, row_im in zip(rows[:half], rows[half:]) for re, im in zip(row_re, row_im)]
+
+
+def run(program: str, iterator: str, system: list, path: str) -> None:
+    """
+    Runs P.U.L.S.E. with the given iterator and writes the output into path.
+    """
+    command = [program, *system, "--iterator", iterator, "--path", path + "/"]
+    result = subprocess.run(command, stdout=subprocess.DEVNULL, stderr=subprocess.STDOUT)
+    if result.returncode != 0:
+        sys.exit(f"'{' '.join(command)}' failed with exit code {result.returncode}")
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--program", type=str, required=True, help="Path to the P.U.L.S.E. executable.")
+    parser.add_argument("--reference", type=str, required=False, help="Reference iterator.", default="rk4")
+    parser.add_argument("--iterator", type=str, required=False, help="Iterator to check.", default="ssfm")
+    parser.add_argument("--tolerance", type=float, required=False, help="Largest relative L2 error.", default=1e-1)
+    parser.add_argument("system", nargs=argparse.REMAINDER, help="System arguments after --. Defaults to a periodic TE/TM run.")
+    args = parser.parse_args()
+    system = [a for a in args.system if a != "--"] or default_system
+
+    failed = False
+    with tempfile.TemporaryDirectory() as tmp:
+        for iterator in (args.reference, args.iterator):
+            os.makedirs(os.path.join(tmp, iterator), exist_ok=True)
+            run(os.path.abspath(args.program), iterator, system, os.path.join(tmp, iterator))
+        for component in ("wavefunction_plus", "wavefunction_minus"):
+            reference_file = os.path.join(tmp, args.reference, component + ".txt")
+            if not os.path.exists(reference_file):
+                continue
+            reference = load_complex_matrix(reference_file)
+            test = load_complex_matrix(os.path.join(tmp, args.iterator, component + ".txt"))
+            norm = math.sqrt(sum(abs(r) ** 2 for r in reference))
+            error = math.sqrt(sum(abs(t - r) ** 2 for t, r in zip(test, reference))) / norm
+            print(f"{component}: relative L2 error of {args.iterator} against {args.reference} is {error:.3e}")
+            failed = failed or not error <= args.tolerance
+
+    sys.exit(1 if failed else 0)